@@ -1,5 +1,6 @@
 #include"classes/Shader.h"
 #include"classes/Mesh.h"
+#include"classes/NormalMatrix.h"
 #include"classes/Camera.h"
 #include"classes/stb_image.h"
 #include <glad/glad.h>
@@ -125,12 +126,13 @@ int main() {
         out vec3 Normal;
         out vec2 TexCoord;
         uniform mat4 model;
+        uniform mat3 normalMatrix; // inverse-transpose of model, from the CPU
         uniform mat4 view;
         uniform mat4 projection;
 
         void main(){
             FragPos = vec3(model*vec4(aPos,1.0));
-            Normal = mat3(transpose(inverse(model)))*aNormal;
+            Normal = normalMatrix*aNormal;
             gl_Position = projection*view*vec4(aPos,1.0);
             TexCoord = aTexCoord;
         }
@@ -232,6 +234,7 @@ int main() {
 
         shader.use();
         shader.setMat4("model",model);
+        shader.setMat3("normalMatrix", normalMatrix(model, TRANSFORM_RIGID)); // pure rotation
         shader.setMat4("view",view);
         shader.setMat4("projection",projection);
         shader.setVec3("objectColor",mat.Color);
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+// Growable array of trivially copyable values on a 64-byte boundary (one
+// cache line, one AVX-512 register), for SoA storage read by SIMD kernels.
+template <typename T>
+class AlignedArray {
+public:
+    static const size_t ALIGNMENT = 64;
+
+    AlignedArray() {}
+    AlignedArray(const AlignedArray&) = delete;
+    AlignedArray& operator=(const AlignedArray&) = delete;
+    ~AlignedArray() { release(); }
+
+    // Keeps existing elements; new elements are set to fill.
+    void resize(size_t count, T fill = T()) {
+        if (count > cap) {
+            T* grown = static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(ALIGNMENT)));
+            if (items) std::memcpy(grown, items, n * sizeof(T));
+            release();
+            items = grown;
+            cap = count;
+        }
+        for (size_t i = n; i < count; ++i) items[i] = fill;
+        n = count;
+    }
+
+    T* data() { return items; }
+    const T* data() const { return items; }
+    size_t size() const { return n; }
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+
+private:
+    T* items = nullptr;
+    size_t n = 0;
+    size_t cap = 0;
+
+    void release() {
+        if (items) ::operator delete(items, std::align_val_t(ALIGNMENT));
+        items = nullptr;
+        cap = 0;
+    }
+};
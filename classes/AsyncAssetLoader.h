@@ -0,0 +1,215 @@
+#pragma once
+#include "AsyncIO.h"
+#include "ObjLoader.h"
+#include "PakArchive.h"
+#include "stb_image.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Texture and OBJ loading on top of AsyncIO. Requests are collected and sent
+// as one batch by flush(); files are read asynchronously, decoded on the pool
+// as soon as their read completes, and the GL work is queued for update() on
+// the thread that owns the context. Entries found in the attached PakArchive
+// skip the file read and decode straight from the mapping.
+class AsyncAssetLoader {
+public:
+    bool flipTextures = true;
+
+    explicit AsyncAssetLoader(unsigned int threads = 0, unsigned int queueDepth = 64)
+        : pool(threads), io(pool, queueDepth) {}
+
+    ~AsyncAssetLoader() { io.waitAll(); }
+
+    void setArchive(const PakArchive* archive) { pak = archive; }
+
+    // textureOut receives the GL texture name once uploaded in update().
+    // mipLevel > 0 uploads the image halved that many times, so a streamed
+    // texture can start coarse and be replaced by finer levels later.
+    void requestTexture(const std::string& path, unsigned int* textureOut,
+                        std::function<void(unsigned int)> onReady = nullptr, int mipLevel = 0) {
+        bool flip = flipTextures;
+        auto decode = [this, path, textureOut, onReady, flip, mipLevel](const uint8_t* bytes, size_t size, bool ok) {
+            auto image = std::make_shared<DecodedImage>();
+            if (ok) {
+                stbi_set_flip_vertically_on_load_thread(flip);
+                image->pixels = stbi_load_from_memory(bytes, static_cast<int>(size),
+                                                      &image->width, &image->height, &image->channels, 0);
+                for (int i = 0; i < mipLevel && image->pixels && (image->width > 1 || image->height > 1); ++i)
+                    halve(*image);
+            }
+            post([image, path, textureOut, onReady] {
+                unsigned int texture = upload(*image, path);
+                if (textureOut) *textureOut = texture;
+                if (onReady) onReady(texture);
+            });
+        };
+        request(path, decode);
+    }
+
+    // Image size from the header only, read synchronously (from the pak
+    // when it has the file); for sizing streamed levels before loading.
+    bool textureInfo(const std::string& path, int& width, int& height, int& channels) const {
+        if (pak) {
+            PakSpan span = pak->find(path);
+            if (span) return stbi_info_from_memory(span.data, static_cast<int>(span.size), &width, &height, &channels) != 0;
+            std::vector<uint8_t> bytes;
+            if (pak->contains(path))
+                return pak->read(path, bytes) &&
+                       stbi_info_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, &channels) != 0;
+        }
+        return stbi_info(path.c_str(), &width, &height, &channels) != 0;
+    }
+
+    // onReady runs on the update() thread so it may create the Mesh directly.
+    void requestObj(const std::string& path, std::function<void(ObjMeshData&)> onReady) {
+        auto decode = [this, onReady](const uint8_t* bytes, size_t size, bool ok) {
+            auto mesh = std::make_shared<ObjMeshData>();
+            // one pool thread parses; the pool is already busy with other files
+            if (ok) ObjLoader::parse(reinterpret_cast<const char*>(bytes), size, *mesh, 1);
+            post([mesh, onReady] { onReady(*mesh); });
+        };
+        request(path, decode);
+    }
+
+    // Sends everything requested since the last flush as one batch.
+    void flush() {
+        if (!batch.empty()) io.submit(std::move(batch));
+        batch.clear();
+    }
+
+    // Call once per frame on the GL thread. Runs at most maxUploads GL jobs
+    // so a burst of completions does not stall one frame.
+    void update(size_t maxUploads = 4) {
+        flush();
+        io.poll();
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mainMutex);
+            size_t n = std::min(maxUploads, mainQueue.size());
+            ready.assign(std::make_move_iterator(mainQueue.begin()), std::make_move_iterator(mainQueue.begin() + n));
+            mainQueue.erase(mainQueue.begin(), mainQueue.begin() + n);
+        }
+        for (auto& job : ready) job();
+    }
+
+    // Blocks until every request has been read, decoded and uploaded.
+    void finish() {
+        flush();
+        io.waitAll();
+        pool.wait();
+        while (pendingUploads() > 0) update(static_cast<size_t>(-1));
+    }
+
+    bool idle() {
+        return batch.empty() && decoding == 0 && pendingUploads() == 0;
+    }
+
+private:
+    struct DecodedImage {
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0, channels = 0;
+        ~DecodedImage() { if (pixels) stbi_image_free(pixels); }
+    };
+
+    typedef std::function<void(const uint8_t*, size_t, bool)> DecodeJob;
+
+    ThreadPool pool;
+    AsyncIO io;
+    const PakArchive* pak = nullptr;
+    std::vector<AsyncReadRequest> batch;
+    std::mutex mainMutex;
+    std::vector<std::function<void()>> mainQueue;
+    std::atomic<size_t> decoding{ 0 }; // requested but not yet queued for upload
+
+    size_t pendingUploads() {
+        std::lock_guard<std::mutex> lock(mainMutex);
+        return mainQueue.size();
+    }
+
+    void post(std::function<void()> job) {
+        std::lock_guard<std::mutex> lock(mainMutex);
+        mainQueue.push_back(std::move(job));
+    }
+
+    void request(const std::string& path, DecodeJob job) {
+        ++decoding;
+        DecodeJob decode = [this, job](const uint8_t* bytes, size_t size, bool ok) {
+            job(bytes, size, ok);
+            --decoding;
+        };
+        if (pak) {
+            PakSpan span = pak->find(path);
+            if (span) {
+                pool.submit([decode, span] { decode(span.data, span.size, true); });
+                return;
+            }
+            if (pak->contains(path)) {
+                const PakArchive* archive = pak;
+                pool.submit([decode, archive, path] {
+                    std::vector<uint8_t> bytes;
+                    bool ok = archive->read(path, bytes);
+                    decode(bytes.data(), bytes.size(), ok);
+                });
+                return;
+            }
+        }
+        AsyncReadRequest r;
+        r.path = path;
+        r.onComplete = [decode](std::vector<uint8_t>& data, bool ok) { decode(data.data(), data.size(), ok); };
+        batch.push_back(std::move(r));
+    }
+
+    // 2x2 box filter; odd edges repeat their last row/column.
+    static void halve(DecodedImage& image) {
+        int w = std::max(1, image.width / 2), h = std::max(1, image.height / 2), c = image.channels;
+        unsigned char* out = static_cast<unsigned char*>(malloc(size_t(w) * h * c)); // freed by stbi_image_free
+        for (int y = 0; y < h; ++y) {
+            int y0 = std::min(y * 2, image.height - 1), y1 = std::min(y * 2 + 1, image.height - 1);
+            for (int x = 0; x < w; ++x) {
+                int x0 = std::min(x * 2, image.width - 1), x1 = std::min(x * 2 + 1, image.width - 1);
+                for (int k = 0; k < c; ++k) {
+                    int sum = image.pixels[(size_t(y0) * image.width + x0) * c + k] + image.pixels[(size_t(y0) * image.width + x1) * c + k] +
+                              image.pixels[(size_t(y1) * image.width + x0) * c + k] + image.pixels[(size_t(y1) * image.width + x1) * c + k];
+                    out[(size_t(y) * w + x) * c + k] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        stbi_image_free(image.pixels);
+        image.pixels = out;
+        image.width = w;
+        image.height = h;
+    }
+
+    static unsigned int upload(const DecodedImage& image, const std::string& path) {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        if (!image.pixels) {
+            std::cout << "Failed to load texture at path: " << path << std::endl;
+            return textureID;
+        }
+
+        GLenum format = GL_RGB;
+        if (image.channels == 1) format = GL_RED;
+        else if (image.channels == 4) format = GL_RGBA;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        return textureID;
+    }
+};
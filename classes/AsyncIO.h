@@ -0,0 +1,224 @@
+#pragma once
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ENGINE_USE_IO_URING
+#include <liburing.h>
+#endif
+
+// Called on a pool thread with the whole file, so decode work runs right
+// where the read completed. ok is false when the file could not be read.
+typedef std::function<void(std::vector<uint8_t>& data, bool ok)> AsyncReadCallback;
+
+struct AsyncReadRequest {
+    std::string path;
+    AsyncReadCallback onComplete;
+};
+
+// Batched whole-file reads. With ENGINE_USE_IO_URING (link liburing) reads
+// go through one io_uring with up to queueDepth requests in flight and
+// completions are dispatched to the pool; otherwise, or when the kernel
+// refuses the ring, each read is a blocking pread on a pool thread.
+//
+// submit/poll/waitAll are meant to be called from one thread (the main loop).
+class AsyncIO {
+public:
+    explicit AsyncIO(ThreadPool& pool, unsigned int queueDepth = 64)
+        : pool(pool), queueDepth(queueDepth) {
+#ifdef ENGINE_USE_IO_URING
+        int err = io_uring_queue_init(queueDepth, &ring, 0);
+        ringReady = (err == 0);
+        if (!ringReady)
+            std::cout << "WARNING::ASYNC_IO::IO_URING_UNAVAILABLE (" << -err << "), using pread pool" << std::endl;
+#endif
+    }
+
+    ~AsyncIO() {
+        waitAll();
+#ifdef ENGINE_USE_IO_URING
+        if (ringReady) io_uring_queue_exit(&ring);
+#endif
+    }
+
+    AsyncIO(const AsyncIO&) = delete;
+    AsyncIO& operator=(const AsyncIO&) = delete;
+
+    bool usingIoUring() const { return ringReady; }
+
+    void submit(std::vector<AsyncReadRequest> batch) {
+        for (auto& r : batch) {
+            ++outstanding;
+            if (ringReady) queued.push_back(std::move(r));
+            else submitBlocking(std::move(r));
+        }
+        if (ringReady) fillRing();
+    }
+
+    void submit(const std::string& path, AsyncReadCallback onComplete) {
+        std::vector<AsyncReadRequest> batch(1);
+        batch[0].path = path;
+        batch[0].onComplete = std::move(onComplete);
+        submit(std::move(batch));
+    }
+
+    // Reaps finished reads and hands them to decode jobs. Never blocks.
+    void poll() { reap(false); }
+
+    // Blocks until every read and its completion callback has run.
+    void waitAll() {
+        while (ringReady && (inFlight > 0 || !queued.empty() || !continued.empty())) reap(true);
+        pool.wait();
+    }
+
+    // Requests submitted but whose callbacks have not finished yet.
+    size_t pendingCount() const { return outstanding.load(); }
+
+private:
+    struct InFlight {
+        AsyncReadRequest request;
+        std::vector<uint8_t> data;
+        int fd = -1;
+        size_t done = 0;
+    };
+
+    ThreadPool& pool;
+    unsigned int queueDepth;
+    bool ringReady = false;
+    std::deque<AsyncReadRequest> queued;
+    std::deque<InFlight*> continued; // short reads that found the SQ full
+    size_t inFlight = 0;
+    std::atomic<size_t> outstanding{ 0 };
+
+#ifdef ENGINE_USE_IO_URING
+    struct io_uring ring;
+#endif
+
+    // Opens the file and sizes the destination buffer; fd < 0 on failure.
+    static int openForRead(const std::string& path, std::vector<uint8_t>& data) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return -1;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return -1; }
+        data.resize(static_cast<size_t>(st.st_size));
+        return fd;
+    }
+
+    void complete(AsyncReadRequest&& request, std::vector<uint8_t>&& data, bool ok) {
+        if (!ok) std::cout << "ERROR::ASYNC_IO::READ_FAILED " << request.path << std::endl;
+        auto job = std::make_shared<std::pair<AsyncReadRequest, std::vector<uint8_t>>>(std::move(request), std::move(data));
+        pool.submit([this, job, ok] {
+            if (job->first.onComplete) job->first.onComplete(job->second, ok);
+            --outstanding;
+        });
+    }
+
+    void submitBlocking(AsyncReadRequest&& request) {
+        auto r = std::make_shared<AsyncReadRequest>(std::move(request));
+        pool.submit([this, r] {
+            std::vector<uint8_t> data;
+            int fd = openForRead(r->path, data);
+            bool ok = fd >= 0;
+            size_t done = 0;
+            while (ok && done < data.size()) {
+                ssize_t n = pread(fd, data.data() + done, data.size() - done, static_cast<off_t>(done));
+                if (n <= 0) ok = false;
+                else done += static_cast<size_t>(n);
+            }
+            if (fd >= 0) ::close(fd);
+            if (!ok) std::cout << "ERROR::ASYNC_IO::READ_FAILED " << r->path << std::endl;
+            if (r->onComplete) r->onComplete(data, ok);
+            --outstanding;
+        });
+    }
+
+#ifdef ENGINE_USE_IO_URING
+    void fillRing() {
+        bool added = false;
+        // finish started files before opening new ones
+        while (inFlight < queueDepth && !continued.empty() && queueRead(continued.front())) {
+            continued.pop_front();
+            ++inFlight;
+            added = true;
+        }
+        while (inFlight < queueDepth && continued.empty() && !queued.empty()) {
+            InFlight* op = new InFlight();
+            op->request = std::move(queued.front());
+            queued.pop_front();
+            op->fd = openForRead(op->request.path, op->data);
+            if (op->fd < 0 || op->data.empty()) {
+                if (op->fd >= 0) ::close(op->fd);
+                complete(std::move(op->request), std::move(op->data), op->fd >= 0);
+                delete op;
+                continue;
+            }
+            if (!queueRead(op)) {
+                queued.push_front(std::move(op->request));
+                ::close(op->fd);
+                delete op;
+                break;
+            }
+            ++inFlight;
+            added = true;
+        }
+        if (added) io_uring_submit(&ring);
+    }
+
+    bool queueRead(InFlight* op) {
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (!sqe) return false;
+        io_uring_prep_read(sqe, op->fd, op->data.data() + op->done,
+                           static_cast<unsigned int>(op->data.size() - op->done), op->done);
+        io_uring_sqe_set_data(sqe, op);
+        return true;
+    }
+
+    void reap(bool block) {
+        if (!ringReady) return;
+        struct io_uring_cqe* cqe = nullptr;
+        bool resubmit = false;
+        while (inFlight > 0) {
+            int err = (block && !resubmit) ? io_uring_wait_cqe(&ring, &cqe) : io_uring_peek_cqe(&ring, &cqe);
+            if (err != 0 || !cqe) break;
+            block = false; // after the first completion just drain what is ready
+
+            InFlight* op = static_cast<InFlight*>(io_uring_cqe_get_data(cqe));
+            int res = cqe->res;
+            io_uring_cqe_seen(&ring, cqe);
+
+            if (res > 0) op->done += static_cast<size_t>(res);
+            if (res > 0 && op->done < op->data.size()) {
+                // short read, continue where it stopped; with the SQ full
+                // fillRing picks it up once this batch is submitted
+                if (queueRead(op)) {
+                    resubmit = true;
+                } else {
+                    --inFlight;
+                    continued.push_back(op);
+                }
+                continue;
+            }
+            ::close(op->fd);
+            --inFlight;
+            complete(std::move(op->request), std::move(op->data), res >= 0 && op->done == op->data.size());
+            delete op;
+        }
+        if (resubmit) io_uring_submit(&ring);
+        fillRing();
+    }
+#else
+    void fillRing() {}
+    void reap(bool) {}
+#endif
+};
@@ -0,0 +1,293 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cmath>
+#include <cstdint>
+
+// Narrowphase for the box, our dominant shape: oriented box against box,
+// plane and sphere, each producing a manifold of up to four points. The
+// box-box test is the 15-axis separating axis test (3 face normals of each
+// box, 9 edge cross products); on overlap the axis of least penetration
+// picks the contact feature. Faces clip the incident face of the other box
+// against the reference face's side planes, edges meet at the closest
+// points of the two edges. Face axes are preferred over nearly equal edge
+// axes so resting stacks keep stable face contacts instead of flickering
+// between features.
+
+struct OrientedBox {
+    glm::vec3 center = glm::vec3(0.0f);
+    glm::vec3 axes[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+    glm::vec3 halfExtents = glm::vec3(0.5f);
+};
+
+// Columns of the quaternion's rotation matrix (q must be unit length).
+inline void quaternionAxes(const glm::quat& q, glm::vec3 axes[3]) {
+    float x = q.x, y = q.y, z = q.z, w = q.w;
+    axes[0] = glm::vec3(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y));
+    axes[1] = glm::vec3(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x));
+    axes[2] = glm::vec3(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y));
+}
+
+inline OrientedBox orientedBox(const glm::vec3& center, const glm::quat& q, const glm::vec3& halfExtents) {
+    OrientedBox box;
+    box.center = center;
+    quaternionAxes(q, box.axes);
+    box.halfExtents = halfExtents;
+    return box;
+}
+
+struct ContactPoint {
+    glm::vec3 position = glm::vec3(0.0f); // halfway between the two surfaces
+    float depth = 0.0f;                   // penetration along the normal, >= 0
+};
+
+// Normal points from the first shape to the second. a and b are free for
+// the caller (PhysicsWorld stores the bodies' handle slots).
+struct ContactManifold {
+    glm::vec3 normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    ContactPoint points[4];
+    int count = 0;
+    uint32_t a = 0, b = 0;
+};
+
+namespace box_collision_detail {
+
+// Keeps four of `count` points that span the largest area: the deepest,
+// the farthest from it, then the farthest on either side of that line.
+inline void reduceContacts(const ContactPoint* in, int count, const glm::vec3& normal, ContactManifold& m) {
+    if (count <= 4) {
+        for (int i = 0; i < count; ++i) m.points[i] = in[i];
+        m.count = count;
+        return;
+    }
+    int first = 0;
+    for (int i = 1; i < count; ++i)
+        if (in[i].depth > in[first].depth) first = i;
+    int second = first == 0 ? 1 : 0;
+    float best = -1.0f;
+    for (int i = 0; i < count; ++i) {
+        glm::vec3 d = in[i].position - in[first].position;
+        float d2 = glm::dot(d, d);
+        if (i != first && d2 > best) { best = d2; second = i; }
+    }
+    int third = -1, fourth = -1;
+    float most = 0.0f, least = 0.0f;
+    glm::vec3 edge = in[second].position - in[first].position;
+    for (int i = 0; i < count; ++i) {
+        if (i == first || i == second) continue;
+        float area = glm::dot(glm::cross(edge, in[i].position - in[first].position), normal);
+        if (third < 0 || area > most) { most = area; third = i; }
+        if (fourth < 0 || area < least) { least = area; fourth = i; }
+    }
+    m.points[0] = in[first];
+    m.points[1] = in[second];
+    m.points[2] = in[third];
+    m.count = 3;
+    if (fourth != third) m.points[m.count++] = in[fourth];
+}
+
+// Sutherland-Hodgman against the plane dot(p, n) <= offset; out holds 8.
+inline int clipPolygon(const glm::vec3* in, int count, const glm::vec3& n, float offset, glm::vec3* out) {
+    int written = 0;
+    for (int i = 0; i < count; ++i) {
+        const glm::vec3& p = in[i];
+        const glm::vec3& q = in[(i + 1) % count];
+        float dp = glm::dot(p, n) - offset, dq = glm::dot(q, n) - offset;
+        if (dp <= 0.0f) out[written++] = p;
+        if ((dp < 0.0f) != (dq < 0.0f) && dp != dq) out[written++] = p + (q - p) * (dp / (dp - dq));
+    }
+    return written;
+}
+
+// Face contact: `ref` owns the face with normal refNormal (pointing at
+// `inc`, unit, one of ref's axes, index refAxis).
+inline int faceContact(const OrientedBox& ref, int refAxis, const glm::vec3& refNormal, const OrientedBox& inc,
+                       ContactPoint* out) {
+    // incident face: the face of inc most opposed to the reference normal
+    int incAxis = 0;
+    float incDot = 0.0f;
+    for (int j = 0; j < 3; ++j) {
+        float d = glm::dot(inc.axes[j], refNormal);
+        if (std::fabs(d) > std::fabs(incDot)) { incDot = d; incAxis = j; }
+    }
+    glm::vec3 faceCentre = inc.center + inc.axes[incAxis] * (incDot > 0.0f ? -inc.halfExtents[incAxis] : inc.halfExtents[incAxis]);
+    int u = (incAxis + 1) % 3, v = (incAxis + 2) % 3;
+    glm::vec3 du = inc.axes[u] * inc.halfExtents[u], dv = inc.axes[v] * inc.halfExtents[v];
+    glm::vec3 polygon[8] = { faceCentre + du + dv, faceCentre - du + dv, faceCentre - du - dv, faceCentre + du - dv };
+    glm::vec3 scratch[8];
+    int count = 4;
+
+    int s = (refAxis + 1) % 3, t = (refAxis + 2) % 3;
+    const int sides[2] = { s, t };
+    for (int side : sides) {
+        glm::vec3 axis = ref.axes[side];
+        float centre = glm::dot(ref.center, axis), extent = ref.halfExtents[side];
+        count = clipPolygon(polygon, count, axis, centre + extent, scratch);
+        if (!count) return 0;
+        count = clipPolygon(scratch, count, -axis, extent - centre, polygon);
+        if (!count) return 0;
+    }
+
+    float faceOffset = glm::dot(ref.center, refNormal) + ref.halfExtents[refAxis];
+    int written = 0;
+    for (int i = 0; i < count; ++i) {
+        float depth = faceOffset - glm::dot(polygon[i], refNormal);
+        if (depth < 0.0f) continue;
+        out[written].position = polygon[i] + refNormal * (depth * 0.5f);
+        out[written].depth = depth;
+        ++written;
+    }
+    return written;
+}
+
+// Point on a box edge along `axis`, on the side of each other axis given
+// by `toward`.
+inline glm::vec3 supportEdge(const OrientedBox& box, int axis, const glm::vec3& toward) {
+    glm::vec3 p = box.center;
+    for (int k = 0; k < 3; ++k) {
+        if (k == axis) continue;
+        p += box.axes[k] * (glm::dot(box.axes[k], toward) > 0.0f ? box.halfExtents[k] : -box.halfExtents[k]);
+    }
+    return p;
+}
+
+} // namespace box_collision_detail
+
+inline bool collideBoxBox(const OrientedBox& a, const OrientedBox& b, ContactManifold& m) {
+    using namespace box_collision_detail;
+    const float parallelEpsilon = 1e-5f;
+    m.count = 0;
+
+    glm::vec3 t = b.center - a.center;
+    float R[3][3], absR[3][3], ta[3];
+    for (int i = 0; i < 3; ++i) {
+        ta[i] = glm::dot(t, a.axes[i]);
+        for (int j = 0; j < 3; ++j) {
+            R[i][j] = glm::dot(a.axes[i], b.axes[j]);
+            absR[i][j] = std::fabs(R[i][j]) + parallelEpsilon;
+        }
+    }
+    const glm::vec3& ea = a.halfExtents;
+    const glm::vec3& eb = b.halfExtents;
+
+    // separation along each axis (negative = penetration); keep the largest
+    float bestFace = -INFINITY;
+    int faceAxis = -1;
+    for (int i = 0; i < 3; ++i) {
+        float s = std::fabs(ta[i]) - (ea[i] + eb[0] * absR[i][0] + eb[1] * absR[i][1] + eb[2] * absR[i][2]);
+        if (s > 0.0f) return false;
+        if (s > bestFace) { bestFace = s; faceAxis = i; }
+    }
+    float bestB = -INFINITY;
+    int faceAxisB = -1;
+    for (int j = 0; j < 3; ++j) {
+        float s = std::fabs(glm::dot(t, b.axes[j])) - (ea[0] * absR[0][j] + ea[1] * absR[1][j] + ea[2] * absR[2][j] + eb[j]);
+        if (s > 0.0f) return false;
+        if (s > bestB) { bestB = s; faceAxisB = j; }
+    }
+    float bestEdge = -INFINITY;
+    int edgeA = -1, edgeB = -1;
+    glm::vec3 edgeNormal(0.0f);
+    for (int i = 0; i < 3; ++i) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; ++j) {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            glm::vec3 axis = glm::cross(a.axes[i], b.axes[j]);
+            float length = glm::length(axis);
+            if (length < parallelEpsilon) continue; // parallel edges: the face axes cover it
+            float ra = ea[i1] * absR[i2][j] + ea[i2] * absR[i1][j];
+            float rb = eb[j1] * absR[i][j2] + eb[j2] * absR[i][j1];
+            float s = (std::fabs(glm::dot(t, axis)) - (ra + rb)) / length;
+            if (s > 0.0f) return false;
+            if (s > bestEdge) { bestEdge = s; edgeA = i; edgeB = j; edgeNormal = axis / length; }
+        }
+    }
+
+    // prefer faces (A's, then B's) unless an edge axis is clearly shallower
+    const float relativeTolerance = 0.95f, absoluteTolerance = 0.01f;
+    int feature = 0;
+    float best = bestFace;
+    if (bestB > best * relativeTolerance + absoluteTolerance) { feature = 1; best = bestB; }
+    if (bestEdge > best * relativeTolerance + absoluteTolerance) { feature = 2; best = bestEdge; }
+
+    ContactPoint points[8];
+    int count = 0;
+    if (feature == 0) {
+        m.normal = ta[faceAxis] < 0.0f ? -a.axes[faceAxis] : a.axes[faceAxis];
+        count = faceContact(a, faceAxis, m.normal, b, points);
+    } else if (feature == 1) {
+        m.normal = glm::dot(t, b.axes[faceAxisB]) < 0.0f ? -b.axes[faceAxisB] : b.axes[faceAxisB];
+        count = faceContact(b, faceAxisB, -m.normal, a, points);
+    } else {
+        m.normal = glm::dot(edgeNormal, t) < 0.0f ? -edgeNormal : edgeNormal;
+        glm::vec3 pa = supportEdge(a, edgeA, m.normal), pb = supportEdge(b, edgeB, -m.normal);
+        glm::vec3 da = a.axes[edgeA], db = b.axes[edgeB];
+        // closest points of the two edge lines, clamped to the edges
+        glm::vec3 r = pa - pb;
+        float dd = glm::dot(da, db), ra = glm::dot(da, r), rb = glm::dot(db, r);
+        float denom = 1.0f - dd * dd;
+        float sa = denom > parallelEpsilon ? (dd * rb - ra) / denom : 0.0f;
+        sa = glm::clamp(sa, -ea[edgeA], ea[edgeA]);
+        float sb = glm::clamp(rb + dd * sa, -eb[edgeB], eb[edgeB]);
+        points[0].position = (pa + da * sa + pb + db * sb) * 0.5f;
+        points[0].depth = -best;
+        count = 1;
+    }
+    reduceContacts(points, count, m.normal, m);
+    return m.count > 0;
+}
+
+// Plane of points p with dot(planeNormal, p) == planeOffset, solid below.
+// The manifold normal points from the box into the plane (-planeNormal).
+inline bool collideBoxPlane(const OrientedBox& box, const glm::vec3& planeNormal, float planeOffset, ContactManifold& m) {
+    m.count = 0;
+    m.normal = -planeNormal;
+    ContactPoint points[8];
+    int count = 0;
+    for (int corner = 0; corner < 8; ++corner) {
+        glm::vec3 p = box.center;
+        for (int k = 0; k < 3; ++k) p += box.axes[k] * ((corner >> k) & 1 ? box.halfExtents[k] : -box.halfExtents[k]);
+        float depth = planeOffset - glm::dot(planeNormal, p);
+        if (depth < 0.0f) continue;
+        points[count].position = p + planeNormal * (depth * 0.5f);
+        points[count].depth = depth;
+        ++count;
+    }
+    box_collision_detail::reduceContacts(points, count, m.normal, m);
+    return m.count > 0;
+}
+
+// One point; the normal points from the box to the sphere.
+inline bool collideBoxSphere(const OrientedBox& box, const glm::vec3& centre, float radius, ContactManifold& m) {
+    m.count = 0;
+    glm::vec3 d = centre - box.center;
+    glm::vec3 local(glm::dot(d, box.axes[0]), glm::dot(d, box.axes[1]), glm::dot(d, box.axes[2]));
+    glm::vec3 clamped = glm::clamp(local, -box.halfExtents, box.halfExtents);
+    glm::vec3 surface;
+    float depth;
+    if (clamped != local) {
+        // centre outside: the closest point on the box
+        surface = box.center + box.axes[0] * clamped.x + box.axes[1] * clamped.y + box.axes[2] * clamped.z;
+        glm::vec3 offset = centre - surface;
+        float dist2 = glm::dot(offset, offset);
+        if (dist2 > radius * radius) return false;
+        float dist = std::sqrt(dist2);
+        m.normal = offset / dist;
+        depth = radius - dist;
+    } else {
+        // centre inside: push out through the nearest face
+        int axis = 0;
+        float nearest = INFINITY;
+        for (int k = 0; k < 3; ++k) {
+            float gap = box.halfExtents[k] - std::fabs(local[k]);
+            if (gap < nearest) { nearest = gap; axis = k; }
+        }
+        m.normal = local[axis] < 0.0f ? -box.axes[axis] : box.axes[axis];
+        surface = centre + m.normal * nearest;
+        depth = radius + nearest;
+    }
+    m.points[0].position = (surface + centre - m.normal * radius) * 0.5f;
+    m.points[0].depth = depth;
+    m.count = 1;
+    return true;
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct Aabb {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+};
+
+// Strict test: boxes that only touch do not overlap.
+inline bool aabbOverlap(const Aabb& a, const Aabb& b) {
+    return a.min.x < b.max.x && b.min.x < a.max.x && a.min.y < b.max.y && b.min.y < a.max.y &&
+           a.min.z < b.max.z && b.min.z < a.max.z;
+}
+
+// Pair of proxy user values, a < b.
+struct OverlapPair {
+    uint32_t a, b;
+};
+
+// Set of overlapping pairs with O(1) add/remove, kept as a dense array so
+// the narrowphase iterates it linearly. Pairs added or removed since the
+// last clearEvents() are also listed, for callers that only care about
+// changes (contact begin/end, waking bodies).
+class PairCache {
+public:
+    bool add(uint32_t a, uint32_t b) {
+        buildIndex();
+        uint64_t k = key(a, b);
+        if (index.count(k)) return false;
+        index[k] = uint32_t(dense.size());
+        dense.push_back(ordered(a, b));
+        addedPairs.push_back(ordered(a, b));
+        return true;
+    }
+
+    bool remove(uint32_t a, uint32_t b) {
+        buildIndex();
+        auto it = index.find(key(a, b));
+        if (it == index.end()) return false;
+        eraseAt(it->second);
+        index.erase(it);
+        removedPairs.push_back(ordered(a, b));
+        return true;
+    }
+
+    bool contains(uint32_t a, uint32_t b) const {
+        buildIndex();
+        return index.count(key(a, b)) != 0;
+    }
+
+    // Drops every pair that involves the value; O(pairs).
+    void removeAll(uint32_t value) {
+        if (indexStale) {
+            // after replace(): filter without building the index
+            size_t kept = 0;
+            for (const OverlapPair& p : dense) {
+                if (p.a == value || p.b == value) removedPairs.push_back(p);
+                else dense[kept++] = p;
+            }
+            dense.resize(kept);
+            return;
+        }
+        for (size_t i = 0; i < dense.size();) {
+            if (dense[i].a == value || dense[i].b == value) remove(dense[i].a, dense[i].b);
+            else ++i;
+        }
+    }
+
+    const std::vector<OverlapPair>& pairs() const { return dense; }
+    const std::vector<OverlapPair>& added() const { return addedPairs; }
+    const std::vector<OverlapPair>& removed() const { return removedPairs; }
+    size_t size() const { return dense.size(); }
+
+    void clearEvents() {
+        addedPairs.clear();
+        removedPairs.clear();
+    }
+
+    void clear() {
+        index.clear();
+        indexStale = false;
+        dense.clear();
+        clearEvents();
+    }
+
+    // Replaces the whole set, recording the difference as events. For
+    // broadphases that rebuild their pair list every step.
+    void assign(const std::vector<OverlapPair>& current) {
+        buildIndex();
+        generation ^= 1u;
+        for (const OverlapPair& p : current) {
+            uint64_t k = key(p.a, p.b);
+            if (!index.count(k)) add(p.a, p.b);
+            seen[k] = generation;
+        }
+        for (size_t i = 0; i < dense.size();) {
+            uint64_t k = key(dense[i].a, dense[i].b);
+            auto it = seen.find(k);
+            if (it == seen.end() || it->second != generation) {
+                if (it != seen.end()) seen.erase(it);
+                remove(dense[i].a, dense[i].b);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // Takes a new set whose changes the caller already worked out (pairs
+    // ordered a < b, no duplicates), for broadphases that diff in parallel.
+    // current is swapped in and receives the old pairs as scratch; only the
+    // events are copied. The slot index is rebuilt on the next add/remove/
+    // contains, so a caller that only ever replaces never pays for it.
+    void replace(std::vector<OverlapPair>& current, const std::vector<OverlapPair>& added,
+                 const std::vector<OverlapPair>& removed) {
+        dense.swap(current);
+        addedPairs.insert(addedPairs.end(), added.begin(), added.end());
+        removedPairs.insert(removedPairs.end(), removed.begin(), removed.end());
+        indexStale = true;
+    }
+
+private:
+    mutable std::unordered_map<uint64_t, uint32_t> index; // pair key -> dense slot
+    mutable bool indexStale = false;                      // replace() left index behind dense
+    std::unordered_map<uint64_t, uint32_t> seen;          // assign() bookkeeping
+    std::vector<OverlapPair> dense;
+    std::vector<OverlapPair> addedPairs, removedPairs;
+    uint32_t generation = 0;
+
+    static OverlapPair ordered(uint32_t a, uint32_t b) {
+        OverlapPair p;
+        p.a = a < b ? a : b;
+        p.b = a < b ? b : a;
+        return p;
+    }
+
+    static uint64_t key(uint32_t a, uint32_t b) {
+        OverlapPair p = ordered(a, b);
+        return (uint64_t(p.a) << 32) | p.b;
+    }
+
+    void buildIndex() const {
+        if (!indexStale) return;
+        index.clear();
+        for (uint32_t i = 0; i < dense.size(); ++i) index[key(dense[i].a, dense[i].b)] = i;
+        indexStale = false;
+    }
+
+    void eraseAt(uint32_t slot) {
+        uint32_t last = uint32_t(dense.size() - 1);
+        if (slot != last) {
+            dense[slot] = dense[last];
+            index[key(dense[slot].a, dense[slot].b)] = slot;
+        }
+        dense.pop_back();
+    }
+};
+
+// Common interface so broadphases can be swapped and compared on the same
+// scene. Proxies carry a caller value (PhysicsWorld uses the body's handle
+// slot) and pairs are reported in those values. Per step the owner calls
+// pairCache().clearEvents(), moves proxies, then updatePairs().
+class Broadphase {
+public:
+    virtual ~Broadphase() {}
+    virtual const char* name() const = 0;
+    virtual uint32_t addProxy(const Aabb& box, uint32_t userData) = 0;
+    virtual void moveProxy(uint32_t proxy, const Aabb& box) = 0;
+    virtual void removeProxy(uint32_t proxy) = 0;
+    // Brings pairs() up to date with every move since the last call.
+    virtual void updatePairs() {}
+
+    const std::vector<OverlapPair>& pairs() const { return cache.pairs(); }
+    PairCache& pairCache() { return cache; }
+
+protected:
+    PairCache cache;
+};
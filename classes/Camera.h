@@ -19,12 +19,12 @@ public:
         : target(target), radius(radius), yaw(-90.0f), pitch(0.0f),
           sensitivity(0.3f), zoomSpeed(1.0f), lastX(400), lastY(300) {}
 
-    glm::mat4 getViewMatrix() {
+    glm::mat4 getViewMatrix() const {
         glm::vec3 position = getPosition();
         return glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
     }
 
-    glm::vec3 getPosition() {
+    glm::vec3 getPosition() const {
         float x = target.x + radius * cos(glm::radians(pitch)) * cos(glm::radians(yaw));
         float y = target.y + radius * sin(glm::radians(pitch));
         float z = target.z + radius * cos(glm::radians(pitch)) * sin(glm::radians(yaw));
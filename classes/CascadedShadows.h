@@ -0,0 +1,250 @@
+#pragma once
+#include "Frustum.h"
+#include "Hash.h"
+#include "RenderScene.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Directional light shadows with cascaded shadow maps in one depth texture
+// array. Cascades split the view frustum up to shadowDistance (blend of log
+// and uniform splits) and each is fit to the bounding sphere of its slice,
+// so the projection does not swim when the camera turns and its origin is
+// snapped to whole texels.
+//
+// The far cascades (from firstStaticCascade on) have their origin snapped to
+// a coarse grid, so their matrices stay fixed while the camera moves inside
+// a cell. While no dynamic caster's bounds reach into one it is cached and
+// re-rendered only when that matrix changes (light direction, a cell
+// crossing) or the static set changes; a far cascade that a dynamic caster
+// overlaps, and the one frame after it leaves, is redrawn like the near
+// cascades, which draw every caster each frame.
+class CascadedShadows {
+public:
+    static const int CASCADES = 4;      // keep in sync with SHADOW_CASCADES in the shaders
+    static const int TEXTURE_UNIT = 7;
+
+    int resolution = 2048;
+    float shadowDistance = 40.0f;
+    float splitLambda = 0.75f;          // 0 = uniform splits, 1 = logarithmic
+    float casterDistance = 50.0f;       // how far behind a cascade occluders are captured
+    int firstStaticCascade = 2;
+    float staticSnapFraction = 0.25f;   // coarse snap step as a fraction of the cascade radius
+
+    // Needs a current context.
+    void init(ShaderLibrary& library) {
+        shaders = &library;
+        depthProgram = shaders->add("shadow_depth", "shadow_depth.vert", "depth_only.frag");
+
+        glGenTextures(1, &depthArray);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, CASCADES, 0,
+                     GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        // hardware 2x2 PCF through the comparison sampler
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        const float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::CASCADED_SHADOWS::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Fits the cascades and redraws the ones that are out of date. Call
+    // before the renderer; restores the default framebuffer and viewport.
+    void render(const RenderScene& scene, const RenderView& view) {
+        fit(scene.sunDirection, view);
+        uint64_t staticHash = hashStatic(scene);
+
+        renderedLastFrame = 0;
+        Shader* depthShader = shaders->get(depthProgram, 0);
+        if (!depthShader) return; // build failure already logged; shadows keep their last contents
+        Shader& depth = *depthShader;
+        depth.use();
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, resolution, resolution);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+
+        for (int c = 0; c < CASCADES; ++c) {
+            Cascade& cascade = cascades[c];
+            bool cached = c >= firstStaticCascade;
+            bool dynamicInside = cached && dynamicCasterInside(scene, cascade.matrix);
+            bool upToDate = cascade.valid && !cascade.hasDynamic && cascade.renderedStaticHash == staticHash &&
+                            std::memcmp(&cascade.renderedMatrix, &cascade.matrix, sizeof(glm::mat4)) == 0;
+            if (cached && upToDate && !dynamicInside) continue;
+
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, c);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            depth.setMat4("lightSpaceMatrix", cascade.matrix);
+            for (const DrawItem& item : scene.items) {
+                if (!item.castsShadow) continue;
+                depth.setMat4("model", item.model);
+                item.mesh->DrawDepth(item.indexed);
+            }
+            cascade.renderedMatrix = cascade.matrix;
+            cascade.renderedStaticHash = staticHash;
+            cascade.hasDynamic = dynamicInside; // redraw once more after it leaves
+            cascade.valid = true;
+            ++renderedLastFrame;
+        }
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, view.width, view.height);
+    }
+
+    // Frame graph version of render(): the cascade array is imported and
+    // written by one pass, and scene.shadowMap lets lighting passes read it.
+    RenderResource addPass(RenderGraph& graph, RenderScene& scene, const RenderView& view) {
+        RenderTextureDesc desc;
+        desc.width = desc.height = resolution;
+        desc.internalFormat = GL_DEPTH_COMPONENT24;
+        scene.shadowMap = graph.importTexture("shadow_cascades", depthArray, desc);
+        RenderPassBuilder pass = graph.addPass("shadows");
+        pass.writeDepth(scene.shadowMap);
+        pass.execute([this, &scene, &view](RenderGraph&) { render(scene, view); });
+        return scene.shadowMap;
+    }
+
+    // Binds the depth array and cascade uniforms to a SHADOWS variant.
+    void bind(const Shader& shader) const {
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("shadowMap", TEXTURE_UNIT);
+        for (int c = 0; c < CASCADES; ++c) {
+            std::string index = "[" + std::to_string(c) + "]";
+            shader.setMat4("cascadeMatrices" + index, cascades[c].matrix);
+            shader.setFloat("cascadeSplits" + index, cascades[c].splitFar);
+        }
+    }
+
+    // Cascades actually redrawn by the last render(); cached ones are skipped.
+    int cascadesRenderedLastFrame() const { return renderedLastFrame; }
+
+    // Forces every cascade to redraw next frame (e.g. after a resolution change).
+    void invalidate() {
+        for (Cascade& c : cascades) c.valid = false;
+    }
+
+    void cleanUp() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (depthArray) glDeleteTextures(1, &depthArray);
+        fbo = depthArray = 0;
+    }
+
+private:
+    struct Cascade {
+        glm::mat4 matrix = glm::mat4(1.0f);
+        glm::mat4 renderedMatrix = glm::mat4(0.0f);
+        uint64_t renderedStaticHash = 0;
+        float splitFar = 0.0f;
+        bool valid = false;
+        bool hasDynamic = false; // last render included a dynamic caster
+    };
+
+    ShaderLibrary* shaders = nullptr;
+    ShaderLibrary::ProgramId depthProgram = 0;
+    unsigned int depthArray = 0;
+    unsigned int fbo = 0;
+    Cascade cascades[CASCADES];
+    int renderedLastFrame = 0;
+
+    void fit(const glm::vec3& sunDirection, const RenderView& view) {
+        glm::vec3 dir = glm::normalize(sunDirection);
+        glm::vec3 up = std::fabs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.0f), dir, up);
+        glm::mat4 inverseView = glm::inverse(view.view);
+        float tanX = 1.0f / view.projection[0][0];
+        float tanY = 1.0f / view.projection[1][1];
+        float zNear = view.nearPlane;
+        float zFar = std::min(shadowDistance, view.farPlane);
+
+        float splitNear = zNear;
+        for (int c = 0; c < CASCADES; ++c) {
+            float t = float(c + 1) / CASCADES;
+            float logSplit = zNear * std::pow(zFar / zNear, t);
+            float uniformSplit = zNear + (zFar - zNear) * t;
+            float splitFar = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+
+            // bounding sphere of the slice: centre on the view axis, so the
+            // radius only depends on the projection and never on rotation
+            float centerDepth = 0.5f * (splitNear + splitFar);
+            float radius = 0.0f;
+            for (float d : { splitNear, splitFar }) {
+                glm::vec3 corner(tanX * d, tanY * d, -d);
+                radius = std::max(radius, glm::length(corner - glm::vec3(0.0f, 0.0f, -centerDepth)));
+            }
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+            glm::vec3 center = glm::vec3(inverseView * glm::vec4(0.0f, 0.0f, -centerDepth, 1.0f));
+
+            glm::vec3 lightCenter = glm::vec3(lightRotation * glm::vec4(center, 1.0f));
+            float step = 2.0f * radius / resolution; // one texel
+            if (c >= firstStaticCascade) {
+                // coarse snap, grown by one step so the slice stays covered
+                step = radius * staticSnapFraction;
+                radius += step;
+                step = std::max(step, 2.0f * radius / resolution);
+            }
+            lightCenter.x = std::floor(lightCenter.x / step) * step;
+            lightCenter.y = std::floor(lightCenter.y / step) * step;
+            if (c >= firstStaticCascade) lightCenter.z = std::floor(lightCenter.z / step) * step;
+
+            glm::mat4 projection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+                                              lightCenter.y - radius, lightCenter.y + radius,
+                                              -lightCenter.z - radius - casterDistance,
+                                              -lightCenter.z + radius + step);
+            cascades[c].matrix = projection * lightRotation;
+            cascades[c].splitFar = splitFar;
+            splitNear = splitFar;
+        }
+    }
+
+    // Whether any dynamic caster's bounding sphere reaches into the light
+    // frustum. Items without a bounding radius count as everywhere.
+    static bool dynamicCasterInside(const RenderScene& scene, const glm::mat4& lightMatrix) {
+        Frustum f = frustumFromMatrix(lightMatrix);
+        for (const DrawItem& item : scene.items) {
+            if (item.isStatic || !item.castsShadow) continue;
+            if (item.boundingRadius <= 0.0f) return true;
+            const glm::mat4& m = item.model;
+            float scale2 = std::max(glm::dot(glm::vec3(m[0]), glm::vec3(m[0])),
+                                    std::max(glm::dot(glm::vec3(m[1]), glm::vec3(m[1])), glm::dot(glm::vec3(m[2]), glm::vec3(m[2]))));
+            float radius = item.boundingRadius * std::sqrt(scale2);
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; ++p)
+                inside = f.planes[p][0] * m[3][0] + f.planes[p][1] * m[3][1] + f.planes[p][2] * m[3][2] + f.planes[p][3] >= -radius;
+            if (inside) return true;
+        }
+        return false;
+    }
+
+    static uint64_t hashStatic(const RenderScene& scene) {
+        uint64_t h = FNV1A_SEED;
+        for (const DrawItem& item : scene.items) {
+            if (!item.isStatic || !item.castsShadow) continue;
+            h = fnv1a(&item.mesh, sizeof(item.mesh), h);
+            h = fnv1a(&item.model, sizeof(item.model), h);
+        }
+        return h;
+    }
+};
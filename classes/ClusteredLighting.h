@@ -0,0 +1,233 @@
+#pragma once
+#include "Shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CLUSTER_SSE2 1
+#endif
+
+// Point light when spotCosOuter <= -1, spot light otherwise.
+struct ClusterLight {
+    glm::vec3 position = glm::vec3(0.0f);
+    float radius = 5.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+    glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    float spotCosInner = -1.0f;
+    float spotCosOuter = -1.0f;
+};
+
+// Clustered forward shading. The view frustum is split into a 16x9 screen
+// tile grid with 24 exponentially spaced depth slices; every frame each
+// light's bounding sphere is tested against the cluster AABBs (four clusters
+// per SSE step) and the resulting per-cluster light lists are uploaded to
+// buffer textures read by the CLUSTERED_LIGHTS path of phong.frag.
+class ClusteredLighting {
+public:
+    static const int TILES_X = 16;
+    static const int TILES_Y = 9;
+    static const int SLICES = 24;
+    static const int CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+    static const int MAX_LIGHTS_PER_CLUSTER = 128;
+
+    // Texture units used by the three buffer textures.
+    static const int LIGHT_DATA_UNIT = 4;
+    static const int CLUSTER_GRID_UNIT = 5;
+    static const int LIGHT_INDEX_UNIT = 6;
+
+    std::vector<ClusterLight> lights;
+
+    void init() {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        formats[0] = GL_RGBA32F; formats[1] = GL_RG32UI; formats[2] = GL_R32UI;
+        for (int i = 0; i < 3; ++i) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // Rebuilds the cluster AABBs; only needed when the projection changes.
+    void setProjection(float fovYRadians, float aspect, float nearPlane, float farPlane) {
+        if (fovYRadians == fovY && aspect == aspectRatio && nearPlane == zNear && farPlane == zFar) return;
+        fovY = fovYRadians; aspectRatio = aspect; zNear = nearPlane; zFar = farPlane;
+
+        float tanY = std::tan(fovY * 0.5f);
+        float tanX = tanY * aspectRatio;
+        for (int z = 0; z < SLICES; ++z) {
+            float d0 = sliceDepth(z), d1 = sliceDepth(z + 1);
+            for (int y = 0; y < TILES_Y; ++y) {
+                float ny0 = -1.0f + 2.0f * y / TILES_Y, ny1 = -1.0f + 2.0f * (y + 1) / TILES_Y;
+                for (int x = 0; x < TILES_X; ++x) {
+                    float nx0 = -1.0f + 2.0f * x / TILES_X, nx1 = -1.0f + 2.0f * (x + 1) / TILES_X;
+                    // view space looks down -z; the tile is widest at its far depth
+                    float xs[4] = { nx0 * tanX * d0, nx1 * tanX * d0, nx0 * tanX * d1, nx1 * tanX * d1 };
+                    float ys[4] = { ny0 * tanY * d0, ny1 * tanY * d0, ny0 * tanY * d1, ny1 * tanY * d1 };
+                    int i = clusterIndex(x, y, z);
+                    minX[i] = *std::min_element(xs, xs + 4); maxX[i] = *std::max_element(xs, xs + 4);
+                    minY[i] = *std::min_element(ys, ys + 4); maxY[i] = *std::max_element(ys, ys + 4);
+                    minZ[i] = -d1; maxZ[i] = -d0;
+                }
+            }
+        }
+    }
+
+    // Assigns lights to clusters and uploads the lists. view is the camera
+    // view matrix matching the projection given to setProjection.
+    void update(const glm::mat4& view) {
+        size_t lightCount = lights.size();
+        counts.assign(CLUSTER_COUNT, 0);
+        pairs.clear();
+
+        for (size_t l = 0; l < lightCount; ++l) {
+            const ClusterLight& light = lights[l];
+            glm::vec3 c = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            float r = light.radius;
+            float depthMin = -c.z - r, depthMax = -c.z + r;
+            if (depthMax < zNear || depthMin > zFar) continue;
+            int z0 = sliceOf(std::max(depthMin, zNear));
+            int z1 = sliceOf(std::min(depthMax, zFar));
+            for (int z = z0; z <= z1; ++z) testSlice(z, c, r, static_cast<uint32_t>(l));
+        }
+
+        // prefix sum into (offset, count) and scatter light indices
+        grid.resize(CLUSTER_COUNT * 2);
+        uint32_t offset = 0;
+        for (int i = 0; i < CLUSTER_COUNT; ++i) {
+            uint32_t n = std::min<uint32_t>(counts[i], MAX_LIGHTS_PER_CLUSTER);
+            grid[i * 2] = offset;
+            grid[i * 2 + 1] = n;
+            offset += n;
+        }
+        indices.resize(std::max<uint32_t>(offset, 1));
+        std::vector<uint32_t>& cursor = counts; // reuse as fill cursor
+        std::fill(cursor.begin(), cursor.end(), 0);
+        for (uint64_t p : pairs) {
+            uint32_t cluster = static_cast<uint32_t>(p >> 32);
+            uint32_t& k = cursor[cluster];
+            if (k < grid[cluster * 2 + 1]) indices[grid[cluster * 2] + k++] = static_cast<uint32_t>(p);
+        }
+
+        packed.resize(std::max<size_t>(lightCount, 1) * 12);
+        for (size_t l = 0; l < lightCount; ++l) {
+            const ClusterLight& light = lights[l];
+            float* d = &packed[l * 12];
+            d[0] = light.position.x; d[1] = light.position.y; d[2] = light.position.z; d[3] = light.radius;
+            d[4] = light.color.x * light.intensity; d[5] = light.color.y * light.intensity;
+            d[6] = light.color.z * light.intensity; d[7] = light.spotCosOuter;
+            d[8] = light.direction.x; d[9] = light.direction.y; d[10] = light.direction.z; d[11] = light.spotCosInner;
+        }
+
+        upload(0, packed.data(), packed.size() * sizeof(float));
+        upload(1, grid.data(), grid.size() * sizeof(uint32_t));
+        upload(2, indices.data(), indices.size() * sizeof(uint32_t));
+        assignedIndices = offset;
+    }
+
+    // Binds the buffer textures and the slicing parameters to a
+    // CLUSTERED_LIGHTS shader variant.
+    void bind(const Shader& shader, int screenWidth, int screenHeight) const {
+        const int units[3] = { LIGHT_DATA_UNIT, CLUSTER_GRID_UNIT, LIGHT_INDEX_UNIT };
+        for (int i = 0; i < 3; ++i) {
+            glActiveTexture(GL_TEXTURE0 + units[i]);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("lightData", LIGHT_DATA_UNIT);
+        shader.setInt("clusterGrid", CLUSTER_GRID_UNIT);
+        shader.setInt("lightIndices", LIGHT_INDEX_UNIT);
+        float logRatio = std::log(zFar / zNear);
+        shader.setVec2("clusterTileSize", glm::vec2(float(screenWidth) / TILES_X, float(screenHeight) / TILES_Y));
+        shader.setVec2("clusterSliceParams", glm::vec2(SLICES / logRatio, SLICES * std::log(zNear) / logRatio));
+    }
+
+    size_t lastAssignedIndices() const { return assignedIndices; }
+
+    void cleanUp() {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+    }
+
+private:
+    float fovY = 0.0f, aspectRatio = 0.0f, zNear = 0.1f, zFar = 100.0f;
+    // SoA cluster bounds in view space, padded for 4-wide loads
+    alignas(16) float minX[CLUSTER_COUNT], minY[CLUSTER_COUNT], minZ[CLUSTER_COUNT];
+    alignas(16) float maxX[CLUSTER_COUNT], maxY[CLUSTER_COUNT], maxZ[CLUSTER_COUNT];
+
+    std::vector<uint32_t> counts;
+    std::vector<uint64_t> pairs; // (cluster << 32) | light
+    std::vector<uint32_t> grid;
+    std::vector<uint32_t> indices;
+    std::vector<float> packed;
+    size_t assignedIndices = 0;
+
+    unsigned int buffers[3] = { 0, 0, 0 };
+    unsigned int textures[3] = { 0, 0, 0 };
+    GLenum formats[3];
+
+    static int clusterIndex(int x, int y, int z) { return (z * TILES_Y + y) * TILES_X + x; }
+
+    float sliceDepth(int slice) const {
+        return zNear * std::pow(zFar / zNear, float(slice) / SLICES);
+    }
+
+    int sliceOf(float depth) const {
+        int s = static_cast<int>(std::floor(std::log(depth / zNear) / std::log(zFar / zNear) * SLICES));
+        return std::min(std::max(s, 0), SLICES - 1);
+    }
+
+    void hit(int cluster, uint32_t light) {
+        ++counts[cluster];
+        pairs.push_back((static_cast<uint64_t>(cluster) << 32) | light);
+    }
+
+    // Sphere vs every cluster AABB of one slice. TILES_X * TILES_Y is a
+    // multiple of 4 and slices start 16-byte aligned, so no tail handling.
+    void testSlice(int z, const glm::vec3& c, float r, uint32_t light) {
+        const int begin = z * TILES_X * TILES_Y;
+        const int end = begin + TILES_X * TILES_Y;
+#ifdef CLUSTER_SSE2
+        const __m128 cx = _mm_set1_ps(c.x), cy = _mm_set1_ps(c.y), cz = _mm_set1_ps(c.z);
+        const __m128 r2 = _mm_set1_ps(r * r);
+        const __m128 zero = _mm_setzero_ps();
+        for (int i = begin; i < end; i += 4) {
+            __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(minX + i), cx), zero),
+                                   _mm_max_ps(_mm_sub_ps(cx, _mm_load_ps(maxX + i)), zero));
+            __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(minY + i), cy), zero),
+                                   _mm_max_ps(_mm_sub_ps(cy, _mm_load_ps(maxY + i)), zero));
+            __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(minZ + i), cz), zero),
+                                   _mm_max_ps(_mm_sub_ps(cz, _mm_load_ps(maxZ + i)), zero));
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            int mask = _mm_movemask_ps(_mm_cmple_ps(d2, r2));
+            if (mask == 0) continue;
+            for (int b = 0; b < 4; ++b)
+                if (mask & (1 << b)) hit(i + b, light);
+        }
+#else
+        for (int i = begin; i < end; ++i) {
+            float dx = std::max(minX[i] - c.x, 0.0f) + std::max(c.x - maxX[i], 0.0f);
+            float dy = std::max(minY[i] - c.y, 0.0f) + std::max(c.y - maxY[i], 0.0f);
+            float dz = std::max(minZ[i] - c.z, 0.0f) + std::max(c.z - maxZ[i], 0.0f);
+            if (dx * dx + dy * dy + dz * dz <= r * r) hit(i, light);
+        }
+#endif
+    }
+
+    void upload(int i, const void* data, size_t bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, NULL, GL_STREAM_DRAW); // orphan last frame's storage
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
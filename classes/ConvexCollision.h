@@ -0,0 +1,504 @@
+#pragma once
+#include "BoxCollision.h"
+#include "Broadphase.h"
+#include "Mesh.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// General convex narrowphase. A shape is anything with a support function
+// (its farthest point along a direction), so boxes, spheres and point
+// clouds taken straight from a Mesh all go through the same code:
+//
+//   GJK walks a simplex of the Minkowski difference A - B towards the
+//       origin, giving the distance and closest points of separated shapes
+//   EPA grows a polytope from GJK's final simplex when the shapes overlap,
+//       giving the penetration depth and normal
+//
+// Each pair keeps the last separating axis in a GjkCache. The next query
+// starts from it, and for a pair that is still apart (resting near each
+// other, or coherent motion in general) one support call along the old
+// axis usually proves separation without building a simplex at all.
+
+// Interleaved position stream (stride 8) of a mesh, for building convex
+// shapes from it. Needs the CPU copy of the vertices; zero-copy meshes do
+// not keep one, and give nullptr.
+inline const float* meshCpuVertices(const Mesh& mesh) {
+    if (mesh.vertices.empty()) {
+        std::cout << "ERROR::CONVEX::MESH_HAS_NO_CPU_VERTICES" << std::endl;
+        return nullptr;
+    }
+    return mesh.vertices.data();
+}
+
+// Support function in the shape's own space.
+class ConvexShape {
+public:
+    virtual ~ConvexShape() {}
+    virtual glm::vec3 support(const glm::vec3& direction) const = 0;
+};
+
+class SphereShape : public ConvexShape {
+public:
+    float radius;
+    explicit SphereShape(float radius = 0.5f) : radius(radius) {}
+    glm::vec3 support(const glm::vec3& direction) const override {
+        float length = glm::length(direction);
+        return length > 0.0f ? direction * (radius / length) : glm::vec3(radius, 0.0f, 0.0f);
+    }
+};
+
+class BoxShape : public ConvexShape {
+public:
+    glm::vec3 halfExtents;
+    explicit BoxShape(const glm::vec3& halfExtents = glm::vec3(0.5f)) : halfExtents(halfExtents) {}
+    glm::vec3 support(const glm::vec3& d) const override {
+        return glm::vec3(d.x < 0.0f ? -halfExtents.x : halfExtents.x, d.y < 0.0f ? -halfExtents.y : halfExtents.y,
+                         d.z < 0.0f ? -halfExtents.z : halfExtents.z);
+    }
+};
+
+// Convex hull of a point set, found by scanning every point. Fine for the
+// few dozen unique corners of typical collision meshes.
+class PointCloudShape : public ConvexShape {
+public:
+    std::vector<glm::vec3> points;
+
+    PointCloudShape() {}
+    explicit PointCloudShape(const std::vector<glm::vec3>& points) : points(points) {}
+
+    // Positions from the interleaved 8-float Mesh layout, duplicates
+    // (shared corners of flat-shaded faces) dropped.
+    static PointCloudShape fromInterleaved(const float* vertices, size_t vertexCount, size_t stride = 8) {
+        PointCloudShape shape;
+        for (size_t i = 0; i < vertexCount; ++i) {
+            glm::vec3 p(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]);
+            bool seen = false;
+            for (const glm::vec3& q : shape.points)
+                if (q == p) { seen = true; break; }
+            if (!seen) shape.points.push_back(p);
+        }
+        return shape;
+    }
+
+    static PointCloudShape fromMesh(const Mesh& mesh) {
+        const float* vertices = meshCpuVertices(mesh);
+        return vertices ? fromInterleaved(vertices, mesh.vertices.size() / 8) : PointCloudShape();
+    }
+
+    glm::vec3 support(const glm::vec3& direction) const override {
+        if (points.empty()) return glm::vec3(0.0f);
+        size_t best = 0;
+        float bestDot = glm::dot(points[0], direction);
+        for (size_t i = 1; i < points.size(); ++i) {
+            float d = glm::dot(points[i], direction);
+            if (d > bestDot) { bestDot = d; best = i; }
+        }
+        return points[best];
+    }
+};
+
+// A shape placed in the world. The shape is borrowed.
+struct ConvexInstance {
+    const ConvexShape* shape = nullptr;
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 axes[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+
+    glm::vec3 support(const glm::vec3& direction) const {
+        glm::vec3 local(glm::dot(direction, axes[0]), glm::dot(direction, axes[1]), glm::dot(direction, axes[2]));
+        glm::vec3 p = shape->support(local);
+        return position + axes[0] * p.x + axes[1] * p.y + axes[2] * p.z;
+    }
+};
+
+inline ConvexInstance convexInstance(const ConvexShape& shape, const glm::vec3& position, const glm::quat& orientation) {
+    ConvexInstance instance;
+    instance.shape = &shape;
+    instance.position = position;
+    quaternionAxes(orientation, instance.axes);
+    return instance;
+}
+
+// Per-pair state carried between frames.
+struct GjkCache {
+    glm::vec3 axis = glm::vec3(0.0f); // last B-to-A separating direction; zero = none yet
+};
+
+struct GjkResult {
+    bool overlap = false;
+    float distance = 0.0f;               // 0 when overlapping
+    glm::vec3 pointA = glm::vec3(0.0f);  // closest points, when separated
+    glm::vec3 pointB = glm::vec3(0.0f);
+    int iterations = 0;                  // support calls made
+};
+
+namespace convex_detail {
+
+// A vertex of the Minkowski difference with the two support points that
+// made it, so closest points on the shapes follow from the barycentrics.
+struct SupportPoint {
+    glm::vec3 w, a, b;
+};
+
+inline SupportPoint supportOf(const ConvexInstance& a, const ConvexInstance& b, const glm::vec3& direction) {
+    SupportPoint s;
+    s.a = a.support(direction);
+    s.b = b.support(-direction);
+    s.w = s.a - s.b;
+    return s;
+}
+
+struct Simplex {
+    SupportPoint points[4];
+    float weights[4];
+    int count = 0;
+};
+
+// Keeps the points with non-zero weight.
+inline void compact(Simplex& s) {
+    int kept = 0;
+    for (int i = 0; i < s.count; ++i) {
+        if (s.weights[i] <= 0.0f) continue;
+        s.points[kept] = s.points[i];
+        s.weights[kept] = s.weights[i];
+        ++kept;
+    }
+    s.count = kept;
+}
+
+// Barycentric weights of the point of triangle abc nearest the origin
+// (Ericson, Real-Time Collision Detection 5.1.5).
+inline void closestOnTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float weights[3]) {
+    glm::vec3 ab = b - a, ac = c - a;
+    float d1 = -glm::dot(ab, a), d2 = -glm::dot(ac, a);
+    if (d1 <= 0.0f && d2 <= 0.0f) { weights[0] = 1.0f; weights[1] = weights[2] = 0.0f; return; }
+    float d3 = -glm::dot(ab, b), d4 = -glm::dot(ac, b);
+    if (d3 >= 0.0f && d4 <= d3) { weights[1] = 1.0f; weights[0] = weights[2] = 0.0f; return; }
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float v = d1 / (d1 - d3);
+        weights[0] = 1.0f - v; weights[1] = v; weights[2] = 0.0f;
+        return;
+    }
+    float d5 = -glm::dot(ab, c), d6 = -glm::dot(ac, c);
+    if (d6 >= 0.0f && d5 <= d6) { weights[2] = 1.0f; weights[0] = weights[1] = 0.0f; return; }
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float w = d2 / (d2 - d6);
+        weights[0] = 1.0f - w; weights[1] = 0.0f; weights[2] = w;
+        return;
+    }
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        weights[0] = 0.0f; weights[1] = 1.0f - w; weights[2] = w;
+        return;
+    }
+    float sum = va + vb + vc;
+    if (sum <= 0.0f) { weights[0] = 1.0f; weights[1] = weights[2] = 0.0f; return; } // degenerate triangle
+    float denom = 1.0f / sum;
+    weights[1] = vb * denom;
+    weights[2] = vc * denom;
+    weights[0] = 1.0f - weights[1] - weights[2];
+}
+
+// Replaces the simplex by the smallest sub-simplex holding its point
+// nearest the origin and returns that point. A tetrahedron that contains
+// the origin is left whole.
+inline glm::vec3 closestOnSimplex(Simplex& s, bool& containsOrigin) {
+    containsOrigin = false;
+    if (s.count == 1) {
+        s.weights[0] = 1.0f;
+    } else if (s.count == 2) {
+        glm::vec3 ab = s.points[1].w - s.points[0].w;
+        float length2 = glm::dot(ab, ab);
+        float t = length2 > 0.0f ? glm::clamp(-glm::dot(s.points[0].w, ab) / length2, 0.0f, 1.0f) : 0.0f;
+        s.weights[0] = 1.0f - t;
+        s.weights[1] = t;
+    } else if (s.count == 3) {
+        closestOnTriangle(s.points[0].w, s.points[1].w, s.points[2].w, s.weights);
+    } else {
+        // nearest of the faces the origin lies outside of
+        static const int FACES[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+        float bestDistance = INFINITY;
+        float best[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        bool outsideAny = false;
+        for (const int* f : FACES) {
+            const glm::vec3 &a = s.points[f[0]].w, &b = s.points[f[1]].w, &c = s.points[f[2]].w, &d = s.points[f[3]].w;
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float sideOrigin = -glm::dot(n, a), sideOpposite = glm::dot(n, d - a);
+            // a flat tetrahedron has no inside; treat every face as a candidate
+            if (sideOrigin * sideOpposite > 0.0f && std::fabs(sideOpposite) > 1e-12f) continue;
+            outsideAny = true;
+            float w[3];
+            closestOnTriangle(a, b, c, w);
+            glm::vec3 p = a * w[0] + b * w[1] + c * w[2];
+            float distance = glm::dot(p, p);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best[f[0]] = w[0]; best[f[1]] = w[1]; best[f[2]] = w[2]; best[f[3]] = 0.0f;
+            }
+        }
+        if (!outsideAny) {
+            containsOrigin = true;
+            return glm::vec3(0.0f);
+        }
+        for (int i = 0; i < 4; ++i) s.weights[i] = best[i];
+    }
+    compact(s);
+    glm::vec3 v(0.0f);
+    for (int i = 0; i < s.count; ++i) v += s.points[i].w * s.weights[i];
+    return v;
+}
+
+inline GjkResult gjk(const ConvexInstance& a, const ConvexInstance& b, GjkCache& cache, Simplex& s, bool overlapOnly) {
+    const int maxIterations = 64;
+    const float relativeTolerance = 1e-6f, overlapTolerance = 1e-12f;
+    GjkResult result;
+    glm::vec3 v = cache.axis;
+    if (glm::dot(v, v) == 0.0f) v = a.position - b.position;
+    if (glm::dot(v, v) == 0.0f) v = glm::vec3(1.0f, 0.0f, 0.0f);
+    s.count = 0;
+
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        SupportPoint p = supportOf(a, b, -v);
+        ++result.iterations;
+        float vw = glm::dot(v, p.w), vv = glm::dot(v, v);
+        // every point of A - B is at least vw along v: a positive value
+        // proves separation, whatever v is (the cached axis on the first pass)
+        if (overlapOnly && vw > 0.0f) {
+            cache.axis = v;
+            return result;
+        }
+        if (s.count > 0) {
+            bool repeated = false;
+            for (int i = 0; i < s.count; ++i) repeated = repeated || s.points[i].w == p.w;
+            if (repeated || vv - vw <= relativeTolerance * vv) break; // v is as close as it gets
+        }
+        s.points[s.count++] = p;
+        bool containsOrigin;
+        v = closestOnSimplex(s, containsOrigin);
+        if (containsOrigin || glm::dot(v, v) <= overlapTolerance) {
+            result.overlap = true;
+            return result;
+        }
+    }
+
+    for (int i = 0; i < s.count; ++i) {
+        result.pointA += s.points[i].a * s.weights[i];
+        result.pointB += s.points[i].b * s.weights[i];
+    }
+    result.distance = glm::length(v);
+    cache.axis = v;
+    return result;
+}
+
+// Grows the GJK simplex to a tetrahedron with a support call along the
+// axes, then along the normal of whatever it has; false for flat shapes.
+inline bool completeTetrahedron(const ConvexInstance& a, const ConvexInstance& b, Simplex& s) {
+    const float epsilon = 1e-10f;
+    static const glm::vec3 AXES[6] = { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0),
+                                       glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+    if (s.count == 0) s.points[s.count++] = supportOf(a, b, AXES[0]);
+    if (s.count == 1) {
+        for (const glm::vec3& axis : AXES) {
+            SupportPoint p = supportOf(a, b, axis);
+            glm::vec3 d = p.w - s.points[0].w;
+            if (glm::dot(d, d) > epsilon) { s.points[s.count++] = p; break; }
+        }
+    }
+    if (s.count == 2) {
+        glm::vec3 line = s.points[1].w - s.points[0].w;
+        for (const glm::vec3& axis : AXES) {
+            glm::vec3 perpendicular = glm::cross(line, axis);
+            if (glm::dot(perpendicular, perpendicular) <= epsilon) continue;
+            SupportPoint p = supportOf(a, b, perpendicular);
+            glm::vec3 offLine = glm::cross(line, p.w - s.points[0].w);
+            if (glm::dot(offLine, offLine) > epsilon) { s.points[s.count++] = p; break; }
+        }
+    }
+    if (s.count == 3) {
+        glm::vec3 n = glm::cross(s.points[1].w - s.points[0].w, s.points[2].w - s.points[0].w);
+        SupportPoint p = supportOf(a, b, n);
+        if (std::fabs(glm::dot(n, p.w - s.points[0].w)) <= epsilon) p = supportOf(a, b, -n);
+        if (std::fabs(glm::dot(n, p.w - s.points[0].w)) > epsilon) s.points[s.count++] = p;
+    }
+    return s.count == 4;
+}
+
+struct EpaFace {
+    int v[3];
+    glm::vec3 normal;
+    float distance;
+    bool alive;
+};
+
+inline EpaFace makeFace(const std::vector<SupportPoint>& vertices, int i, int j, int k) {
+    EpaFace face;
+    face.v[0] = i; face.v[1] = j; face.v[2] = k;
+    face.alive = true;
+    glm::vec3 n = glm::cross(vertices[j].w - vertices[i].w, vertices[k].w - vertices[i].w);
+    float length = glm::length(n);
+    if (length > 1e-12f) {
+        face.normal = n / length;
+        face.distance = glm::dot(face.normal, vertices[i].w);
+    } else {
+        // sliver: keep it for the topology but never expand it
+        face.normal = glm::vec3(0.0f);
+        face.distance = INFINITY;
+    }
+    return face;
+}
+
+// Expanding polytope: repeatedly pushes out the face nearest the origin
+// with a support point along its normal until the polytope stops growing
+// there. The nearest face is then on the boundary of A - B.
+inline bool epa(const ConvexInstance& a, const ConvexInstance& b, const Simplex& s, ContactManifold& m) {
+    const int maxIterations = 64;
+    const float tolerance = 1e-4f;
+    std::vector<SupportPoint> vertices(s.points, s.points + 4);
+    std::vector<EpaFace> faces;
+    // wind every face outwards, away from the opposite vertex
+    static const int TETRA[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+    for (const int* f : TETRA) {
+        glm::vec3 n = glm::cross(vertices[f[1]].w - vertices[f[0]].w, vertices[f[2]].w - vertices[f[0]].w);
+        if (glm::dot(n, vertices[f[3]].w - vertices[f[0]].w) > 0.0f) faces.push_back(makeFace(vertices, f[0], f[2], f[1]));
+        else faces.push_back(makeFace(vertices, f[0], f[1], f[2]));
+    }
+
+    // nearest live face to the origin, or -1 if the polytope degenerated
+    auto nearestFace = [&faces]() {
+        int nearest = -1;
+        for (size_t i = 0; i < faces.size(); ++i)
+            if (faces[i].alive && (nearest < 0 || faces[i].distance < faces[nearest].distance)) nearest = int(i);
+        return nearest < 0 || faces[nearest].distance == INFINITY ? -1 : nearest;
+    };
+
+    std::vector<std::pair<int, int>> horizon;
+    int nearest = -1;
+    bool converged = false;
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        nearest = nearestFace();
+        if (nearest < 0) return false;
+
+        EpaFace face = faces[nearest];
+        SupportPoint p = supportOf(a, b, face.normal);
+        if (glm::dot(p.w, face.normal) - face.distance <= tolerance) {
+            converged = true;
+            break;
+        }
+
+        int added = int(vertices.size());
+        vertices.push_back(p);
+        horizon.clear();
+        for (EpaFace& f : faces) {
+            if (!f.alive || glm::dot(f.normal, p.w - vertices[f.v[0]].w) <= 0.0f) continue;
+            f.alive = false;
+            // edges shared by two removed faces cancel; the rest form the horizon
+            for (int e = 0; e < 3; ++e) {
+                std::pair<int, int> edge(f.v[e], f.v[(e + 1) % 3]);
+                bool cancelled = false;
+                for (size_t h = 0; h < horizon.size(); ++h) {
+                    if (horizon[h].first == edge.second && horizon[h].second == edge.first) {
+                        horizon[h] = horizon.back();
+                        horizon.pop_back();
+                        cancelled = true;
+                        break;
+                    }
+                }
+                if (!cancelled) horizon.push_back(edge);
+            }
+        }
+        for (const std::pair<int, int>& edge : horizon) faces.push_back(makeFace(vertices, edge.first, edge.second, added));
+    }
+    // out of iterations: the last expansion removed the face picked above,
+    // so fall back to the best live one (curved shapes converge slowly)
+    if (!converged) {
+        nearest = nearestFace();
+        if (nearest < 0) return false;
+    }
+
+    // contact: the projection of the origin onto the nearest face
+    const EpaFace& face = faces[nearest];
+    float w[3];
+    closestOnTriangle(vertices[face.v[0]].w, vertices[face.v[1]].w, vertices[face.v[2]].w, w);
+    glm::vec3 pointA(0.0f), pointB(0.0f);
+    for (int k = 0; k < 3; ++k) {
+        pointA += vertices[face.v[k]].a * w[k];
+        pointB += vertices[face.v[k]].b * w[k];
+    }
+    // translating B by distance along the face normal takes the origin out
+    // of A - B, so the normal already points from A to B
+    m.normal = face.normal;
+    m.points[0].position = (pointA + pointB) * 0.5f;
+    m.points[0].depth = std::max(face.distance, 0.0f);
+    m.count = 1;
+    return true;
+}
+
+} // namespace convex_detail
+
+// Distance between two convex shapes, or overlap.
+inline GjkResult gjkDistance(const ConvexInstance& a, const ConvexInstance& b, GjkCache& cache) {
+    convex_detail::Simplex s;
+    return convex_detail::gjk(a, b, cache, s, false);
+}
+
+// Overlap test only; exits as soon as any separating axis is found.
+inline bool gjkOverlap(const ConvexInstance& a, const ConvexInstance& b, GjkCache& cache) {
+    convex_detail::Simplex s;
+    return convex_detail::gjk(a, b, cache, s, true).overlap;
+}
+
+// One-point manifold for overlapping shapes, normal from A to B.
+inline bool collideConvex(const ConvexInstance& a, const ConvexInstance& b, GjkCache& cache, ContactManifold& m) {
+    m.count = 0;
+    convex_detail::Simplex s;
+    if (!convex_detail::gjk(a, b, cache, s, true).overlap) return false;
+    if (!convex_detail::completeTetrahedron(a, b, s) || !convex_detail::epa(a, b, s, m)) return false;
+    cache.axis = -m.normal;
+    return true;
+}
+
+// GjkCache per broadphase pair. Call prune() after the broadphase update
+// (once per frame is enough) to drop the caches of pairs that separated.
+class GjkCacheMap {
+public:
+    GjkCache& get(uint32_t a, uint32_t b) { return caches[key(a, b)].cache; }
+
+    // Keeps only the caches of pairs still in the set. Works from pairs()
+    // rather than the removed() events, which the owner may clear every
+    // substep; O(pairs + caches).
+    void prune(const PairCache& pairs) {
+        ++generation;
+        for (const OverlapPair& p : pairs.pairs()) {
+            auto it = caches.find(key(p.a, p.b));
+            if (it != caches.end()) it->second.seen = generation;
+        }
+        for (auto it = caches.begin(); it != caches.end();) {
+            if (it->second.seen != generation) it = caches.erase(it);
+            else ++it;
+        }
+    }
+
+    void clear() { caches.clear(); }
+    size_t size() const { return caches.size(); }
+
+private:
+    struct Entry {
+        GjkCache cache;
+        uint32_t seen = 0; // generation of the last prune() that found the pair
+    };
+
+    std::unordered_map<uint64_t, Entry> caches;
+    uint32_t generation = 0;
+
+    static uint64_t key(uint32_t a, uint32_t b) {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+};
@@ -0,0 +1,325 @@
+#pragma once
+#include "ConvexCollision.h"
+#include "Hash.h"
+#include "Mesh.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Convex collision hull with precomputed face planes and vertex adjacency.
+// support() hill-climbs the vertex graph: from any start vertex, step to a
+// neighbour further along the direction until none is. On a convex
+// polytope the local maximum is the global one, so a query touches a
+// handful of vertices instead of all of them.
+struct HullFace {
+    uint32_t v[3];      // counter-clockwise seen from outside
+    glm::vec3 normal;   // outward, unit
+    float offset;       // dot(normal, p) == offset on the face
+};
+
+class ConvexHull : public ConvexShape {
+public:
+    std::vector<glm::vec3> vertices;
+    std::vector<HullFace> faces;
+    // neighbours of vertex i are adjacency[adjacencyStart[i] .. adjacencyStart[i + 1])
+    std::vector<uint32_t> adjacencyStart;
+    std::vector<uint32_t> adjacency;
+
+    glm::vec3 support(const glm::vec3& direction) const override {
+        return vertices.empty() ? glm::vec3(0.0f) : vertices[supportIndex(direction, 0)];
+    }
+
+    // Hill climb from `start`; pass the previous answer for coherent queries.
+    uint32_t supportIndex(const glm::vec3& direction, uint32_t start) const {
+        uint32_t best = start;
+        float bestDot = glm::dot(vertices[best], direction);
+        for (bool improved = true; improved;) {
+            improved = false;
+            for (uint32_t k = adjacencyStart[best]; k < adjacencyStart[best + 1]; ++k) {
+                float d = glm::dot(vertices[adjacency[k]], direction);
+                if (d > bestDot) {
+                    bestDot = d;
+                    best = adjacency[k];
+                    improved = true;
+                }
+            }
+        }
+        return best;
+    }
+};
+
+namespace convex_hull_detail {
+
+struct BuildFace {
+    uint32_t v[3];
+    glm::vec3 normal;
+    float offset;
+    std::vector<uint32_t> outside; // points above this face, assigned to it
+    uint32_t furthest;
+    float furthestDistance;
+    bool alive;
+};
+
+inline uint64_t edgeKey(uint32_t a, uint32_t b) { return (uint64_t(a) << 32) | b; }
+
+// Quickhull state. Faces are triangles; each directed edge maps to the
+// face that owns it, so the face across edge a->b owns b->a.
+class QuickhullBuilder {
+public:
+    std::vector<glm::vec3> points;
+    std::vector<BuildFace> faces;
+    std::unordered_map<uint64_t, uint32_t> edgeFaces;
+    float epsilon = 0.0f;
+
+    uint32_t addFace(uint32_t a, uint32_t b, uint32_t c) {
+        BuildFace face;
+        face.v[0] = a; face.v[1] = b; face.v[2] = c;
+        glm::vec3 n = glm::cross(points[b] - points[a], points[c] - points[a]);
+        float length = glm::length(n);
+        face.normal = length > 0.0f ? n / length : glm::vec3(0.0f);
+        face.offset = glm::dot(face.normal, points[a]);
+        face.furthest = UINT32_MAX;
+        face.furthestDistance = 0.0f;
+        face.alive = true;
+        uint32_t id = uint32_t(faces.size());
+        faces.push_back(face);
+        for (int e = 0; e < 3; ++e) edgeFaces[edgeKey(face.v[e], face.v[(e + 1) % 3])] = id;
+        return id;
+    }
+
+    void removeFace(uint32_t id) {
+        BuildFace& face = faces[id];
+        face.alive = false;
+        for (int e = 0; e < 3; ++e) edgeFaces.erase(edgeKey(face.v[e], face.v[(e + 1) % 3]));
+    }
+
+    float distance(const BuildFace& face, uint32_t p) const { return glm::dot(face.normal, points[p]) - face.offset; }
+
+    // Gives the point to the first candidate face it is above; points
+    // above none are inside the hull and dropped.
+    void assign(uint32_t p, const std::vector<uint32_t>& candidates) {
+        for (uint32_t id : candidates) {
+            BuildFace& face = faces[id];
+            float d = distance(face, p);
+            if (d <= epsilon) continue;
+            face.outside.push_back(p);
+            if (d > face.furthestDistance) {
+                face.furthestDistance = d;
+                face.furthest = p;
+            }
+            return;
+        }
+    }
+
+    bool initialSimplex(uint32_t simplex[4]) {
+        // the two farthest apart of the six axis extremes
+        uint32_t extremes[6] = { 0, 0, 0, 0, 0, 0 };
+        for (uint32_t i = 1; i < points.size(); ++i) {
+            for (int axis = 0; axis < 3; ++axis) {
+                if (points[i][axis] < points[extremes[axis * 2]][axis]) extremes[axis * 2] = i;
+                if (points[i][axis] > points[extremes[axis * 2 + 1]][axis]) extremes[axis * 2 + 1] = i;
+            }
+        }
+        float best = -1.0f;
+        for (int i = 0; i < 6; ++i) {
+            for (int j = i + 1; j < 6; ++j) {
+                glm::vec3 d = points[extremes[i]] - points[extremes[j]];
+                if (glm::dot(d, d) > best) {
+                    best = glm::dot(d, d);
+                    simplex[0] = extremes[i];
+                    simplex[1] = extremes[j];
+                }
+            }
+        }
+        if (std::sqrt(best) <= epsilon) return false;
+
+        // farthest from that line, then farthest from the plane of the three
+        glm::vec3 line = glm::normalize(points[simplex[1]] - points[simplex[0]]);
+        best = -1.0f;
+        for (uint32_t i = 0; i < points.size(); ++i) {
+            glm::vec3 d = points[i] - points[simplex[0]];
+            glm::vec3 off = d - line * glm::dot(d, line);
+            if (glm::dot(off, off) > best) { best = glm::dot(off, off); simplex[2] = i; }
+        }
+        if (std::sqrt(best) <= epsilon) return false;
+
+        glm::vec3 n = glm::normalize(glm::cross(points[simplex[1]] - points[simplex[0]], points[simplex[2]] - points[simplex[0]]));
+        best = -1.0f;
+        for (uint32_t i = 0; i < points.size(); ++i) {
+            float d = std::fabs(glm::dot(n, points[i] - points[simplex[0]]));
+            if (d > best) { best = d; simplex[3] = i; }
+        }
+        return best > epsilon;
+    }
+
+    bool build(size_t maxVertices) {
+        glm::vec3 scale(0.0f);
+        for (const glm::vec3& p : points) scale = glm::max(scale, glm::abs(p));
+        epsilon = (scale.x + scale.y + scale.z) * 1e-5f;
+
+        uint32_t s[4];
+        if (points.size() < 4 || !initialSimplex(s)) return false;
+        // wind the tetrahedron so every face looks away from the fourth point
+        if (glm::dot(glm::cross(points[s[1]] - points[s[0]], points[s[2]] - points[s[0]]), points[s[3]] - points[s[0]]) > 0.0f)
+            std::swap(s[1], s[2]);
+        std::vector<uint32_t> created;
+        created.push_back(addFace(s[0], s[1], s[2]));
+        created.push_back(addFace(s[0], s[3], s[1]));
+        created.push_back(addFace(s[1], s[3], s[2]));
+        created.push_back(addFace(s[2], s[3], s[0]));
+        for (uint32_t p = 0; p < points.size(); ++p)
+            if (p != s[0] && p != s[1] && p != s[2] && p != s[3]) assign(p, created);
+        size_t hullVertices = 4;
+
+        std::vector<uint32_t> visible, stack, orphans;
+        std::vector<std::pair<uint32_t, uint32_t>> horizon;
+        std::vector<unsigned char> visited;
+        while (hullVertices < maxVertices) {
+            // the farthest outside point overall, so a vertex-limited hull
+            // keeps the points that add the most volume
+            uint32_t start = UINT32_MAX;
+            for (uint32_t id = 0; id < faces.size(); ++id)
+                if (faces[id].alive && !faces[id].outside.empty() &&
+                    (start == UINT32_MAX || faces[id].furthestDistance > faces[start].furthestDistance))
+                    start = id;
+            if (start == UINT32_MAX) break;
+            uint32_t eye = faces[start].furthest;
+
+            // flood the faces the eye sees; edges to faces it does not see
+            // form the horizon. Visibility is exact (> 0, not > epsilon):
+            // keeping a face the eye is barely above would fold a sliver
+            // into the hull next to it.
+            visible.clear();
+            horizon.clear();
+            visited.assign(faces.size(), 0);
+            stack.assign(1, start);
+            visited[start] = 1;
+            while (!stack.empty()) {
+                uint32_t id = stack.back();
+                stack.pop_back();
+                visible.push_back(id);
+                for (int e = 0; e < 3; ++e) {
+                    uint32_t a = faces[id].v[e], b = faces[id].v[(e + 1) % 3];
+                    auto across = edgeFaces.find(edgeKey(b, a));
+                    if (across == edgeFaces.end()) return false; // open surface: lost precision
+                    uint32_t next = across->second;
+                    if (visited[next]) continue;
+                    if (distance(faces[next], eye) > 0.0f) {
+                        visited[next] = 1;
+                        stack.push_back(next);
+                    } else {
+                        horizon.push_back(std::make_pair(a, b));
+                    }
+                }
+            }
+
+            orphans.clear();
+            for (uint32_t id : visible) {
+                for (uint32_t p : faces[id].outside)
+                    if (p != eye) orphans.push_back(p);
+                faces[id].outside.clear();
+                faces[id].outside.shrink_to_fit();
+                removeFace(id);
+            }
+            created.clear();
+            for (const std::pair<uint32_t, uint32_t>& edge : horizon) created.push_back(addFace(edge.first, edge.second, eye));
+            for (uint32_t p : orphans) assign(p, created);
+            ++hullVertices;
+        }
+        return true;
+    }
+};
+
+} // namespace convex_hull_detail
+
+// Quickhull over `count` positions `stride` floats apart (8 for the Mesh
+// layout). With more than maxVertices hull points, the hull is grown from
+// the farthest points first and stops at the limit: the result is a
+// slightly smaller hull that keeps the shape's extremes. Returns false
+// for flat or degenerate input.
+inline bool buildConvexHull(const float* positions, size_t count, size_t stride, ConvexHull& hull, size_t maxVertices = 64) {
+    convex_hull_detail::QuickhullBuilder builder;
+    builder.points.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        builder.points.push_back(glm::vec3(positions[i * stride], positions[i * stride + 1], positions[i * stride + 2]));
+    if (!builder.build(std::max<size_t>(maxVertices, 4))) {
+        std::cout << "ERROR::CONVEX_HULL::DEGENERATE_INPUT" << std::endl;
+        return false;
+    }
+
+    // compact to the vertices the surviving faces use
+    std::vector<uint32_t> remap(builder.points.size(), UINT32_MAX);
+    hull.vertices.clear();
+    hull.faces.clear();
+    for (const convex_hull_detail::BuildFace& f : builder.faces) {
+        if (!f.alive) continue;
+        HullFace face;
+        for (int k = 0; k < 3; ++k) {
+            if (remap[f.v[k]] == UINT32_MAX) {
+                remap[f.v[k]] = uint32_t(hull.vertices.size());
+                hull.vertices.push_back(builder.points[f.v[k]]);
+            }
+            face.v[k] = remap[f.v[k]];
+        }
+        face.normal = f.normal;
+        face.offset = f.offset;
+        hull.faces.push_back(face);
+    }
+
+    // every directed face edge names a neighbour exactly once
+    size_t n = hull.vertices.size();
+    hull.adjacencyStart.assign(n + 1, 0);
+    for (const HullFace& face : hull.faces)
+        for (int k = 0; k < 3; ++k) ++hull.adjacencyStart[face.v[k] + 1];
+    for (size_t i = 0; i < n; ++i) hull.adjacencyStart[i + 1] += hull.adjacencyStart[i];
+    hull.adjacency.resize(hull.adjacencyStart[n]);
+    std::vector<uint32_t> fill(hull.adjacencyStart.begin(), hull.adjacencyStart.end() - 1);
+    for (const HullFace& face : hull.faces)
+        for (int k = 0; k < 3; ++k) hull.adjacency[fill[face.v[k]]++] = face.v[(k + 1) % 3];
+    return true;
+}
+
+// Hulls keyed by the content of the position stream, so meshes loaded
+// again (a reloaded Model builds new Mesh objects from the same data) get
+// the hull built the first time. Failed builds are remembered too.
+class ConvexHullCache {
+public:
+    size_t maxVertices = 64;
+
+    const ConvexHull* hullFor(const Mesh& mesh) {
+        const float* vertices = meshCpuVertices(mesh);
+        return vertices ? hullFor(vertices, mesh.vertices.size() / 8, 8) : nullptr;
+    }
+
+    const ConvexHull* hullFor(const float* positions, size_t count, size_t stride) {
+        uint64_t key = contentHash(positions, count, stride);
+        auto it = hulls.find(key);
+        if (it != hulls.end()) return it->second.get();
+        std::unique_ptr<ConvexHull> hull(new ConvexHull());
+        if (!buildConvexHull(positions, count, stride, *hull, maxVertices)) hull.reset();
+        ++builtCount;
+        return (hulls[key] = std::move(hull)).get();
+    }
+
+    size_t size() const { return hulls.size(); }
+    size_t builds() const { return builtCount; }
+    void clear() { hulls.clear(); }
+
+private:
+    std::unordered_map<uint64_t, std::unique_ptr<ConvexHull>> hulls;
+    size_t builtCount = 0;
+
+    // FNV-1a over the positions only (normals and uvs do not change the
+    // hull) and the vertex limit.
+    uint64_t contentHash(const float* positions, size_t count, size_t stride) const {
+        uint64_t h = FNV1A_SEED;
+        for (size_t i = 0; i < count; ++i) h = fnv1a(positions + i * stride, 3 * sizeof(float), h);
+        return fnv1a(&maxVertices, sizeof(maxVertices), h);
+    }
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include "SimdWide.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(SIMD_X86)
+#include <cpuid.h>
+#endif
+
+// Widest SIMD instruction set the CPU and OS both support. The OS part
+// matters: AVX registers are only usable when the kernel saves them on
+// context switch, which XCR0 (read with xgetbv) reports.
+enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2,    // AVX2 + FMA
+    SIMD_AVX512,  // AVX-512F
+};
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_SSE2: return "sse2";
+        case SIMD_AVX2: return "avx2";
+        case SIMD_AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+inline SimdLevel detectSimdLevel() {
+#ifdef SIMD_X86
+    uint32_t leaf1[4] = {}, leaf7[4] = {};
+    uint64_t xcr0 = 0;
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    int maxLeaf = regs[0];
+    __cpuidex(regs, 1, 0);
+    for (int i = 0; i < 4; ++i) leaf1[i] = uint32_t(regs[i]);
+    if (maxLeaf >= 7) {
+        __cpuidex(regs, 7, 0);
+        for (int i = 0; i < 4; ++i) leaf7[i] = uint32_t(regs[i]);
+    }
+    bool osxsave = (leaf1[2] >> 27) & 1;
+    if (osxsave) xcr0 = _xgetbv(0);
+#else
+    unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+    __cpuid_count(1, 0, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+    if (maxLeaf >= 7) __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+    bool osxsave = (leaf1[2] >> 27) & 1;
+    if (osxsave) {
+        uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = (uint64_t(hi) << 32) | lo;
+    }
+#endif
+    bool sse2 = (leaf1[3] >> 26) & 1;
+    bool avx = (leaf1[2] >> 28) & 1;
+    bool fma = (leaf1[2] >> 12) & 1;
+    bool avx2 = (leaf7[1] >> 5) & 1;
+    bool avx512f = (leaf7[1] >> 16) & 1;
+    bool ymmState = (xcr0 & 0x6) == 0x6;     // SSE + AVX state
+    bool zmmState = (xcr0 & 0xe6) == 0xe6;   // plus opmask and upper ZMM state
+
+    if (avx512f && avx2 && fma && zmmState) return SIMD_AVX512;
+    if (avx && avx2 && fma && ymmState) return SIMD_AVX2;
+    if (sse2) return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+// Detected once; ENGINE_SIMD=scalar|sse2|avx2|avx512 lowers it, e.g. to
+// compare kernels or reproduce a report from an older machine. Asking for
+// more than the CPU has falls back to the detected level.
+inline SimdLevel simdLevel() {
+    static const SimdLevel level = [] {
+        SimdLevel detected = detectSimdLevel();
+        const char* request = std::getenv("ENGINE_SIMD");
+        if (!request || !*request) return detected;
+        for (int l = SIMD_SCALAR; l <= SIMD_AVX512; ++l) {
+            if (std::strcmp(request, simdLevelName(SimdLevel(l))) != 0) continue;
+            if (l <= detected) return SimdLevel(l);
+            std::cout << "ERROR::CPU_FEATURES::ENGINE_SIMD_UNSUPPORTED: " << request << ", using "
+                      << simdLevelName(detected) << std::endl;
+            return detected;
+        }
+        std::cout << "ERROR::CPU_FEATURES::ENGINE_SIMD_UNKNOWN: " << request << std::endl;
+        return detected;
+    }();
+    return level;
+}
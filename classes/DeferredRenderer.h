@@ -0,0 +1,145 @@
+#pragma once
+#include "CascadedShadows.h"
+#include "NormalMatrix.h"
+#include "RenderScene.h"
+
+// Geometry pass into a G-buffer (albedo + specular, world normal, material
+// params, depth), then one fullscreen lighting pass. Dynamic lights are
+// shaded per pixel from the clustered light lists, so each pixel only pays
+// for the lights whose volume reaches its cluster and overdraw in the
+// geometry pass never reaches the lighting cost.
+//
+// The G-buffer targets are transient render graph resources, so they come
+// from the graph's pool and can be shared with other passes' targets.
+class DeferredRenderer : public Renderer {
+public:
+    const char* name() const override { return "deferred"; }
+
+    void init(ShaderLibrary& library, MaterialLibrary& materialLibrary) override {
+        shaders = &library;
+        materials = &materialLibrary;
+        geometryProgram = shaders->add("gbuffer", "phong.vert", "gbuffer.frag");
+        lightingProgram = shaders->add("deferred_light", "fullscreen.vert", "deferred_light.frag");
+        shaders->prefetch(lightingProgram, SHADER_CLUSTERED_LIGHTS | SHADER_SHADOWS);
+        glGenVertexArrays(1, &emptyVAO); // core profile needs a VAO even without attributes
+    }
+
+    // Standalone use: runs the passes through a private graph.
+    void render(const RenderScene& scene, const RenderView& view) override {
+        ownGraph.reset(view.width, view.height);
+        addPasses(ownGraph, scene, view);
+        ownGraph.compile();
+        ownGraph.execute();
+    }
+
+    void addPasses(RenderGraph& graph, const RenderScene& scene, const RenderView& view) override {
+        RenderTextureDesc colour;
+        colour.width = view.width;
+        colour.height = view.height;
+        RenderTextureDesc wide = colour;
+        wide.internalFormat = GL_RGBA16F;
+        RenderTextureDesc depthDesc = colour;
+        depthDesc.internalFormat = GL_DEPTH24_STENCIL8;
+
+        RenderPassBuilder geometryPass = graph.addPass("gbuffer");
+        GBuffer g;
+        g.albedo = geometryPass.create("gAlbedo", colour);
+        g.normal = geometryPass.create("gNormal", wide);
+        g.params = geometryPass.create("gParams", colour);
+        g.depth = geometryPass.create("gDepth", depthDesc);
+        geometryPass.write(g.albedo);
+        geometryPass.write(g.normal);
+        geometryPass.write(g.params);
+        geometryPass.writeDepth(g.depth);
+        geometryPass.execute([this, &scene, view](RenderGraph&) { drawGeometry(scene, view); });
+
+        RenderPassBuilder lightingPass = graph.addPass("deferred_lighting");
+        lightingPass.read(g.albedo);
+        lightingPass.read(g.normal);
+        lightingPass.read(g.params);
+        lightingPass.read(g.depth);
+        if (scene.shadowMap != RENDER_NO_RESOURCE) lightingPass.read(scene.shadowMap);
+        lightingPass.writeBackbuffer();
+        lightingPass.execute([this, &scene, view, g](RenderGraph& rg) { drawLighting(rg, g, scene, view); });
+    }
+
+    void cleanUp() override {
+        ownGraph.cleanUp();
+        if (emptyVAO) glDeleteVertexArrays(1, &emptyVAO);
+        emptyVAO = 0;
+    }
+
+private:
+    struct GBuffer {
+        RenderResource albedo, normal, params, depth;
+    };
+
+    ShaderLibrary* shaders = nullptr;
+    MaterialLibrary* materials = nullptr;
+    ShaderLibrary::ProgramId geometryProgram = 0;
+    ShaderLibrary::ProgramId lightingProgram = 0;
+    unsigned int emptyVAO = 0;
+    RenderGraph ownGraph;
+
+    void drawGeometry(const RenderScene& scene, const RenderView& view) {
+        updateNormalMatrices(scene);
+        cullItems(scene, view);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        frameStats.drawCalls = 0;
+        Shader* geometryShader = shaders->get(geometryProgram, 0);
+        if (!geometryShader) return; // build failure already logged; the G-buffer stays cleared
+        Shader& geometry = *geometryShader;
+        materials->bind(geometry);
+        geometry.use();
+        geometry.setMat4("view", view.view);
+        geometry.setMat4("projection", view.projection);
+        geometry.setInt("ourTexture", 0);
+        glActiveTexture(GL_TEXTURE0);
+        for (size_t i = 0; i < scene.items.size(); ++i) {
+            if (!visible[i]) continue;
+            const DrawItem& item = scene.items[i];
+            geometry.setMat4("model", item.model);
+            geometry.setMat3("normalMatrix", normals[i]);
+            geometry.setInt("materialIndex", item.material);
+            item.mesh->Draw(item.indexed);
+            ++frameStats.drawCalls;
+        }
+    }
+
+    void drawLighting(RenderGraph& graph, const GBuffer& g, const RenderScene& scene, const RenderView& view) {
+        uint32_t features = (scene.lights ? uint32_t(SHADER_CLUSTERED_LIGHTS) : 0u) | (scene.shadows ? uint32_t(SHADER_SHADOWS) : 0u);
+        Shader* lightingShader = shaders->get(lightingProgram, features);
+        if (!lightingShader) return; // build failure already logged
+        Shader& lighting = *lightingShader;
+        lighting.use();
+        const RenderResource targets[4] = { g.albedo, g.normal, g.params, g.depth };
+        const char* samplers[4] = { "gAlbedo", "gNormal", "gParams", "gDepth" };
+        for (int i = 0; i < 4; ++i) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, graph.texture(targets[i]));
+            lighting.setInt(samplers[i], i);
+        }
+        lighting.setMat4("inverseViewProjection", glm::inverse(view.projection * view.view));
+        lighting.setMat4("view", view.view);
+        lighting.setVec3("lightColor", scene.lightColor);
+        lighting.setVec3("lightPos", scene.lightPos);
+        lighting.setVec3("viewPos", view.position);
+        if (scene.lights) scene.lights->bind(lighting, view.width, view.height);
+        if (scene.shadows) {
+            lighting.setVec3("sunDirection", scene.sunDirection);
+            lighting.setVec3("sunColor", scene.sunColor);
+            scene.shadows->bind(lighting);
+        }
+
+        glDisable(GL_DEPTH_TEST);
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glEnable(GL_DEPTH_TEST);
+        glActiveTexture(GL_TEXTURE0);
+
+        // hand the scene depth to forward overlays
+        graph.blitToBackbuffer(g.depth, GL_DEPTH_BUFFER_BIT);
+    }
+};
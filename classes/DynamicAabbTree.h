@@ -0,0 +1,360 @@
+#pragma once
+#include "Broadphase.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Dynamic bounding volume tree. Leaves hold "fat" boxes, the proxy's box
+// grown by a margin and stretched along its last motion, so a proxy that
+// moves a little stays inside its fat box and costs nothing. Only proxies
+// that escape are reinserted, and only those query the tree for new pairs,
+// which makes static and sleeping bodies free however many there are.
+//
+// Insertion walks down picking the sibling that adds the least surface
+// area (SAH: the chance a random query hits a node grows with its area);
+// on the way back up AVL-style rotations keep the height logarithmic.
+// Unlike sorting, the tree does not care how proxies are distributed or
+// how much their sizes vary, and it doubles as a spatial index for ray and
+// region queries.
+//
+// Pairs are reported for overlapping fat boxes, so they are conservative;
+// the narrowphase rejects the extras.
+class DynamicAabbTree : public Broadphase {
+public:
+    float margin = 0.1f;                  // added on every side of a fat box
+    float displacementMultiplier = 2.0f;  // stretch along the last move, in moves
+
+    const char* name() const override { return "tree"; }
+
+    uint32_t addProxy(const Aabb& box, uint32_t userData) override {
+        uint32_t leaf = allocateNode();
+        Node& node = nodes[leaf];
+        node.tight = box;
+        node.box = grow(box, margin);
+        node.userData = userData;
+        node.height = 0;
+        node.moved = true;
+        insertLeaf(leaf);
+        userToLeaf[userData] = leaf;
+        moved.push_back(leaf);
+        return leaf;
+    }
+
+    void moveProxy(uint32_t leaf, const Aabb& box) override {
+        Node& node = nodes[leaf];
+        glm::vec3 displacement = (box.min - node.tight.min) * displacementMultiplier;
+        node.tight = box;
+        if (contains(node.box, box)) return;
+
+        removeLeaf(leaf);
+        Aabb fat = grow(box, margin);
+        for (int axis = 0; axis < 3; ++axis) {
+            if (displacement[axis] < 0.0f) fat.min[axis] += displacement[axis];
+            else fat.max[axis] += displacement[axis];
+        }
+        nodes[leaf].box = fat;
+        insertLeaf(leaf);
+        if (!nodes[leaf].moved) {
+            nodes[leaf].moved = true;
+            moved.push_back(leaf);
+        }
+        ++reinsertions;
+    }
+
+    void removeProxy(uint32_t leaf) override {
+        cache.removeAll(nodes[leaf].userData);
+        userToLeaf.erase(nodes[leaf].userData);
+        if (nodes[leaf].moved) moved.erase(std::find(moved.begin(), moved.end(), leaf));
+        removeLeaf(leaf);
+        freeNode(leaf);
+    }
+
+    // New pairs come from querying the moved proxies only; pairs of a moved
+    // proxy whose fat boxes separated are dropped.
+    void updatePairs() override {
+        for (uint32_t leaf : moved) {
+            const Node& node = nodes[leaf];
+            query(node.box, [&](uint32_t other) {
+                if (other != node.userData) cache.add(node.userData, other);
+                return true;
+            });
+        }
+        for (size_t i = 0; i < cache.pairs().size();) {
+            OverlapPair p = cache.pairs()[i];
+            uint32_t a = userToLeaf[p.a], b = userToLeaf[p.b];
+            if ((nodes[a].moved || nodes[b].moved) && !aabbOverlap(nodes[a].box, nodes[b].box)) {
+                cache.remove(p.a, p.b); // swaps the last pair into slot i
+                continue;
+            }
+            ++i;
+        }
+        for (uint32_t leaf : moved) nodes[leaf].moved = false;
+        moved.clear();
+    }
+
+    // Calls fn(userData) for every leaf whose fat box overlaps `box`;
+    // fn returns false to stop.
+    template <typename Fn>
+    void query(const Aabb& box, Fn fn) const {
+        if (root == NULL_NODE) return;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            uint32_t id = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[id];
+            if (!aabbOverlap(node.box, box)) continue;
+            if (node.isLeaf()) {
+                if (!fn(node.userData)) return;
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    // Segment from `from` to `to`. fn(userData, maxFraction) returns the
+    // fraction to clip the segment to: the hit fraction to keep only nearer
+    // hits, maxFraction to go on, 0 to stop.
+    template <typename Fn>
+    void raycast(const glm::vec3& from, const glm::vec3& to, Fn fn) const {
+        if (root == NULL_NODE) return;
+        glm::vec3 dir = to - from;
+        glm::vec3 invDir;
+        for (int axis = 0; axis < 3; ++axis) invDir[axis] = dir[axis] != 0.0f ? 1.0f / dir[axis] : INFINITY;
+        float maxFraction = 1.0f;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            uint32_t id = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[id];
+            if (!raySlab(node.box, from, invDir, maxFraction)) continue;
+            if (node.isLeaf()) {
+                float clipped = fn(node.userData, maxFraction);
+                if (clipped <= 0.0f) return;
+                maxFraction = std::min(maxFraction, clipped);
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    int height() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+    const Aabb& fatBox(uint32_t leaf) const { return nodes[leaf].box; }
+
+    // Leaves reinserted since the last call: the tree's actual work.
+    size_t takeReinsertCount() {
+        size_t n = reinsertions;
+        reinsertions = 0;
+        return n;
+    }
+
+private:
+    static const uint32_t NULL_NODE = UINT32_MAX;
+
+    struct Node {
+        Aabb box;                 // fat for leaves, union of children otherwise
+        Aabb tight;               // leaves: last box given by the caller
+        uint32_t parent = NULL_NODE;
+        uint32_t child1 = NULL_NODE, child2 = NULL_NODE; // child1 doubles as free-list link
+        int height = -1;          // leaf 0, free -1
+        uint32_t userData = 0;
+        bool moved = false;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    std::vector<Node> nodes;
+    uint32_t root = NULL_NODE;
+    uint32_t freeList = NULL_NODE;
+    std::vector<uint32_t> moved;
+    std::unordered_map<uint32_t, uint32_t> userToLeaf;
+    mutable std::vector<uint32_t> stack; // traversal scratch; queries are not reentrant
+    size_t reinsertions = 0;
+
+    static Aabb grow(const Aabb& box, float amount) {
+        Aabb out;
+        out.min = box.min - glm::vec3(amount);
+        out.max = box.max + glm::vec3(amount);
+        return out;
+    }
+
+    static Aabb combine(const Aabb& a, const Aabb& b) {
+        Aabb out;
+        out.min = glm::min(a.min, b.min);
+        out.max = glm::max(a.max, b.max);
+        return out;
+    }
+
+    static bool contains(const Aabb& outer, const Aabb& inner) {
+        return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+               inner.max.x <= outer.max.x && inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+    }
+
+    static float area(const Aabb& box) {
+        glm::vec3 d = box.max - box.min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    static bool raySlab(const Aabb& box, const glm::vec3& from, const glm::vec3& invDir, float maxFraction) {
+        float tmin = 0.0f, tmax = maxFraction;
+        for (int axis = 0; axis < 3; ++axis) {
+            float t1 = (box.min[axis] - from[axis]) * invDir[axis];
+            float t2 = (box.max[axis] - from[axis]) * invDir[axis];
+            if (std::isnan(t1) || std::isnan(t2)) {
+                // parallel ray starting on a slab face
+                if (from[axis] < box.min[axis] || from[axis] > box.max[axis]) return false;
+                continue;
+            }
+            tmin = std::max(tmin, std::min(t1, t2));
+            tmax = std::min(tmax, std::max(t1, t2));
+            if (tmin > tmax) return false;
+        }
+        return true;
+    }
+
+    uint32_t allocateNode() {
+        if (freeList == NULL_NODE) {
+            nodes.push_back(Node());
+            return uint32_t(nodes.size() - 1);
+        }
+        uint32_t id = freeList;
+        freeList = nodes[id].child1;
+        nodes[id] = Node();
+        return id;
+    }
+
+    void freeNode(uint32_t id) {
+        nodes[id] = Node();
+        nodes[id].child1 = freeList;
+        nodes[id].height = -1;
+        freeList = id;
+    }
+
+    // SAH descent: at each node compare the cost of making the leaf its
+    // sibling here against the cheapest cost of pushing it into a child.
+    uint32_t pickSibling(const Aabb& leafBox) const {
+        uint32_t index = root;
+        while (!nodes[index].isLeaf()) {
+            const Node& node = nodes[index];
+            float nodeArea = area(node.box);
+            float combinedArea = area(combine(node.box, leafBox));
+            float siblingCost = 2.0f * combinedArea;
+            float inheritance = 2.0f * (combinedArea - nodeArea); // every ancestor grows too
+
+            float childCost[2];
+            uint32_t children[2] = { node.child1, node.child2 };
+            for (int c = 0; c < 2; ++c) {
+                const Node& child = nodes[children[c]];
+                float grown = area(combine(child.box, leafBox));
+                childCost[c] = (child.isLeaf() ? grown : grown - area(child.box)) + inheritance;
+            }
+            if (siblingCost < childCost[0] && siblingCost < childCost[1]) break;
+            index = childCost[0] < childCost[1] ? node.child1 : node.child2;
+        }
+        return index;
+    }
+
+    void insertLeaf(uint32_t leaf) {
+        if (root == NULL_NODE) {
+            root = leaf;
+            nodes[leaf].parent = NULL_NODE;
+            return;
+        }
+        Aabb leafBox = nodes[leaf].box;
+        uint32_t sibling = pickSibling(leafBox);
+
+        uint32_t oldParent = nodes[sibling].parent;
+        uint32_t newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+        if (oldParent == NULL_NODE) {
+            root = newParent;
+        } else if (nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        } else {
+            nodes[oldParent].child2 = newParent;
+        }
+        refit(nodes[leaf].parent);
+    }
+
+    void removeLeaf(uint32_t leaf) {
+        if (leaf == root) {
+            root = NULL_NODE;
+            return;
+        }
+        uint32_t parent = nodes[leaf].parent;
+        uint32_t grandParent = nodes[parent].parent;
+        uint32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+        if (grandParent == NULL_NODE) {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+        } else {
+            if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+            else nodes[grandParent].child2 = sibling;
+            nodes[sibling].parent = grandParent;
+            refit(grandParent);
+        }
+        freeNode(parent);
+        nodes[leaf].parent = NULL_NODE;
+    }
+
+    // Walks to the root rebalancing and refitting boxes and heights.
+    void refit(uint32_t index) {
+        while (index != NULL_NODE) {
+            index = balance(index);
+            Node& node = nodes[index];
+            node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+            node.box = combine(nodes[node.child1].box, nodes[node.child2].box);
+            index = node.parent;
+        }
+    }
+
+    // If one child of A is two or more levels taller, rotate its taller
+    // grandchild up into A's place. Returns the node now at A's position.
+    uint32_t balance(uint32_t a) {
+        Node& nodeA = nodes[a];
+        if (nodeA.isLeaf() || nodeA.height < 2) return a;
+        uint32_t b = nodeA.child1, c = nodeA.child2;
+        int skew = nodes[c].height - nodes[b].height;
+        if (skew > 1) return rotateUp(a, c, b);
+        if (skew < -1) return rotateUp(a, b, c);
+        return a;
+    }
+
+    // `up` (a child of a) takes a's place; a keeps `other` and the shorter
+    // of up's children, up keeps the taller one.
+    uint32_t rotateUp(uint32_t a, uint32_t up, uint32_t other) {
+        uint32_t f = nodes[up].child1, g = nodes[up].child2;
+        nodes[up].child1 = a;
+        nodes[up].parent = nodes[a].parent;
+        nodes[a].parent = up;
+        uint32_t upParent = nodes[up].parent;
+        if (upParent == NULL_NODE) root = up;
+        else if (nodes[upParent].child1 == a) nodes[upParent].child1 = up;
+        else nodes[upParent].child2 = up;
+
+        uint32_t taller = nodes[f].height > nodes[g].height ? f : g;
+        uint32_t shorter = taller == f ? g : f;
+        nodes[up].child2 = taller;
+        if (nodes[a].child1 == up) nodes[a].child1 = shorter;
+        else nodes[a].child2 = shorter;
+        nodes[shorter].parent = a;
+
+        nodes[a].box = combine(nodes[other].box, nodes[shorter].box);
+        nodes[a].height = 1 + std::max(nodes[other].height, nodes[shorter].height);
+        nodes[up].box = combine(nodes[a].box, nodes[taller].box);
+        nodes[up].height = 1 + std::max(nodes[a].height, nodes[taller].height);
+        return up;
+    }
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include "GpuQuery.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Renders the 3D scene into an offscreen target whose resolution follows
+// the measured GPU frame time, then upscales it to the window. The target
+// is allocated once at window size and the scene uses its lower-left
+// sub-rectangle, so changing scale never reallocates. GPU cost is roughly
+// proportional to pixel count, so the scale moves by sqrt(target/measured),
+// smoothed and with a dead band so it does not oscillate.
+class DynamicResolution {
+public:
+    bool enabled = true;
+    float targetFrameMs = 16.0f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float deadBand = 0.05f;   // ignore timings within 5% of the target
+    float responsiveness = 0.3f;
+
+    void init() {
+        timer.init(GL_TIME_ELAPSED);
+    }
+
+    // Safe to call from framebuffer_size_callback; the target is
+    // reallocated lazily by the next beginFrame().
+    void resize(int windowWidth, int windowHeight) {
+        if (windowWidth == width && windowHeight == height) return;
+        width = windowWidth;
+        height = windowHeight;
+        dirty = true;
+    }
+
+    // Updates the scale from the newest GPU timing, binds the offscreen
+    // target with the scaled viewport, clears it and starts the timer.
+    void beginFrame(float r, float g, float b) {
+        if (dirty) allocate();
+        if (timer.collect() && enabled) adjust(timer.milliseconds());
+        if (!enabled) currentScale = 1.0f;
+
+        renderWidth = std::max(8, (int(width * currentScale) + 7) & ~7);
+        renderHeight = std::max(8, (int(height * currentScale) + 7) & ~7);
+        renderWidth = std::min(renderWidth, width);
+        renderHeight = std::min(renderHeight, height);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, renderWidth, renderHeight);
+        glClearColor(r, g, b, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        timer.begin();
+    }
+
+    void endFrame() { timer.end(); }
+
+    // Upscales the rendered region to the whole window.
+    void present() {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT,
+                          (renderWidth == width && renderHeight == height) ? GL_NEAREST : GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, width, height);
+    }
+
+    unsigned int framebuffer() const { return fbo; }
+    int renderTargetWidth() const { return renderWidth; }
+    int renderTargetHeight() const { return renderHeight; }
+    float scale() const { return currentScale; }
+    double lastGpuMs() const { return timer.milliseconds(); }
+
+    void cleanUp() {
+        release();
+        timer.cleanUp();
+    }
+
+private:
+    GpuQueryRing timer;
+    unsigned int fbo = 0, colour = 0, depth = 0;
+    int width = 0, height = 0;
+    int renderWidth = 0, renderHeight = 0;
+    float currentScale = 1.0f;
+    bool dirty = true;
+
+    void adjust(double gpuMs) {
+        if (gpuMs <= 0.0) return;
+        double ratio = targetFrameMs / gpuMs;
+        if (std::fabs(ratio - 1.0) < deadBand) return;
+        float desired = currentScale * float(std::sqrt(ratio));
+        currentScale += (desired - currentScale) * responsiveness;
+        currentScale = std::min(std::max(currentScale, minScale), maxScale);
+    }
+
+    void allocate() {
+        release();
+        dirty = false;
+        if (width <= 0 || height <= 0) return;
+
+        glGenTextures(1, &colour);
+        glBindTexture(GL_TEXTURE_2D, colour);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // matches the default framebuffer so depth can be blitted into it
+        glGenTextures(1, &depth);
+        glBindTexture(GL_TEXTURE_2D, depth);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colour, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::DYNAMIC_RESOLUTION::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void release() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (colour) glDeleteTextures(1, &colour);
+        if (depth) glDeleteTextures(1, &depth);
+        fbo = colour = depth = 0;
+    }
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <algorithm>
+
+// Accumulator that turns variable frame times into a whole number of fixed
+// simulation steps, so physics runs at the same rate regardless of the
+// render rate. Time left over after the last step becomes alpha(), the
+// fraction of a step the render state lies past the newest simulation
+// state, used to interpolate or extrapolate body transforms.
+//
+// If a frame needs more than maxSubsteps steps the excess time is dropped:
+// the simulation slows down instead of each frame costing more steps than
+// the last (the "spiral of death").
+class FixedTimestep {
+public:
+    float hz = 60.0f;
+    int maxSubsteps = 5;
+
+    // Adds the frame's wall-clock time and returns how many steps to run.
+    int advance(double frameSeconds) {
+        double step = stepSeconds();
+        accumulator += std::max(frameSeconds, 0.0);
+        int steps = int(accumulator / step);
+        accumulator -= steps * step;
+        if (steps > maxSubsteps) {
+            droppedSeconds += (steps - maxSubsteps) * step;
+            steps = maxSubsteps;
+        }
+        return steps;
+    }
+
+    float stepSeconds() const { return 1.0f / hz; }
+    float alpha() const { return float(accumulator / stepSeconds()); }
+
+    // Total simulation time skipped by the substep clamp, for stats.
+    double dropped() const { return droppedSeconds; }
+
+private:
+    double accumulator = 0.0;
+    double droppedSeconds = 0.0;
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include "CascadedShadows.h"
+#include "GpuQuery.h"
+#include "NormalMatrix.h"
+#include "RenderScene.h"
+
+// Single pass Phong over every draw item; dynamic lights come from the
+// clustered light lists when the scene has them.
+//
+// With depthPrepass on, opaque items are first drawn depth-only through the
+// position-only VAO, then the colour pass runs with GL_EQUAL and depth
+// writes off so the Phong shader executes once per visible pixel. That wins
+// with heavy overdraw and loses when the scene is vertex bound, since every
+// vertex is transformed twice; stats() reports both passes to compare.
+class ForwardRenderer : public Renderer {
+public:
+    bool depthPrepass = false;
+
+    const char* name() const override { return "forward"; }
+
+    void init(ShaderLibrary& library, MaterialLibrary& materialLibrary) override {
+        shaders = &library;
+        materials = &materialLibrary;
+        phongProgram = shaders->add("phong", "phong.vert", "phong.frag");
+        prepassProgram = shaders->add("depth_prepass", "phong.vert", "depth_only.frag");
+        shaders->prefetch(phongProgram, SHADER_CLUSTERED_LIGHTS | SHADER_SHADOWS);
+        prepassTimer.init(GL_TIME_ELAPSED);
+        colourTimer.init(GL_TIME_ELAPSED);
+        samplesPassed.init(GL_SAMPLES_PASSED);
+    }
+
+    void render(const RenderScene& scene, const RenderView& view) override {
+        // a shader that failed to build (the library logs why) skips its pass
+        Shader* depthShader = depthPrepass ? shaders->get(prepassProgram, 0) : nullptr;
+        bool prepass = depthShader != nullptr;
+        frameStats.depthPrepass = prepass;
+        frameStats.drawCalls = 0;
+        frameStats.depthDrawCalls = 0;
+        cullItems(scene, view);
+
+        if (prepass) {
+            prepassTimer.begin();
+            Shader& depth = *depthShader;
+            depth.use();
+            depth.setMat4("view", view.view);
+            depth.setMat4("projection", view.projection);
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            for (size_t i = 0; i < scene.items.size(); ++i) {
+                if (!visible[i]) continue;
+                const DrawItem& item = scene.items[i];
+                depth.setMat4("model", item.model);
+                item.mesh->DrawDepth(item.indexed);
+                ++frameStats.depthDrawCalls;
+            }
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
+            prepassTimer.end();
+        }
+
+        updateNormalMatrices(scene);
+        colourTimer.begin();
+        samplesPassed.begin();
+        uint32_t features = (scene.lights ? uint32_t(SHADER_CLUSTERED_LIGHTS) : 0u) | (scene.shadows ? uint32_t(SHADER_SHADOWS) : 0u);
+        Shader* colourShader = shaders->get(phongProgram, features);
+        if (colourShader) {
+            Shader& shader = *colourShader;
+            materials->bind(shader);
+            shader.use();
+            shader.setMat4("view", view.view);
+            shader.setMat4("projection", view.projection);
+            shader.setVec3("lightColor", scene.lightColor);
+            shader.setVec3("lightPos", scene.lightPos);
+            shader.setVec3("viewPos", view.position);
+            shader.setInt("ourTexture", 0);
+            if (scene.lights) scene.lights->bind(shader, view.width, view.height);
+            if (scene.shadows) {
+                shader.setVec3("sunDirection", scene.sunDirection);
+                shader.setVec3("sunColor", scene.sunColor);
+                scene.shadows->bind(shader);
+            }
+
+            glActiveTexture(GL_TEXTURE0);
+            for (size_t i = 0; i < scene.items.size(); ++i) {
+                if (!visible[i]) continue;
+                const DrawItem& item = scene.items[i];
+                shader.setMat4("model", item.model);
+                shader.setMat3("normalMatrix", normals[i]);
+                shader.setInt("materialIndex", item.material);
+                item.mesh->Draw(item.indexed);
+                ++frameStats.drawCalls;
+            }
+        }
+        samplesPassed.end();
+        colourTimer.end();
+
+        if (prepass) {
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+        }
+
+        prepassTimer.collect();
+        frameStats.prepassMs = frameStats.depthPrepass ? prepassTimer.milliseconds() : 0.0;
+        frameStats.colourMs = colourTimer.milliseconds();
+        frameStats.shadedSamples = samplesPassed.value();
+    }
+
+    void cleanUp() override {
+        prepassTimer.cleanUp();
+        colourTimer.cleanUp();
+        samplesPassed.cleanUp();
+    }
+
+private:
+    ShaderLibrary* shaders = nullptr;
+    MaterialLibrary* materials = nullptr;
+    ShaderLibrary::ProgramId phongProgram = 0;
+    ShaderLibrary::ProgramId prepassProgram = 0;
+    GpuQueryRing prepassTimer;
+    GpuQueryRing colourTimer;
+    GpuQueryRing samplesPassed;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cmath>
+
+// Six world-space planes (nx, ny, nz, d), normals pointing inwards, so a
+// point p is inside when dot(n, p) + d >= 0 for all of them. Extracted from
+// a projection * view matrix (Gribb/Hartmann, OpenGL clip space).
+struct Frustum {
+    float planes[6][4];
+};
+
+inline Frustum frustumFromMatrix(const glm::mat4& viewProjection) {
+    const glm::mat4& m = viewProjection;
+    Frustum f;
+    for (int p = 0; p < 6; ++p) {
+        int axis = p / 2;
+        float sign = (p & 1) ? -1.0f : 1.0f;  // left/bottom/near add, right/top/far subtract
+        float len2 = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            f.planes[p][c] = m[c][3] + sign * m[c][axis];
+            if (c < 3) len2 += f.planes[p][c] * f.planes[p][c];
+        }
+        float inv = len2 > 0.0f ? 1.0f / std::sqrt(len2) : 0.0f;
+        for (int c = 0; c < 4; ++c) f.planes[p][c] *= inv;
+    }
+    return f;
+}
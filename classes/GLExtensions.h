@@ -0,0 +1,76 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstring>
+
+// glad is generated for core 3.3 without extensions, so entry points newer
+// than that are fetched here through GLFW when the driver exposes them.
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP GetProgramBinaryFn)(GLuint program, GLsizei bufSize, GLsizei* length,
+                                            GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryFn)(GLuint program, GLenum binaryFormat,
+                                         const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriFn)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP MaxShaderCompilerThreadsFn)(GLuint count);
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+inline bool glHasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (ext && std::strcmp(ext, name) == 0) return true;
+    }
+    return false;
+}
+
+inline bool glVersionAtLeast(int major, int minor) {
+    GLint maj = 0, min = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &maj);
+    glGetIntegerv(GL_MINOR_VERSION, &min);
+    return maj > major || (maj == major && min >= minor);
+}
+
+// GL 4.1 / ARB_get_program_binary
+struct GLProgramBinaryAPI {
+    GetProgramBinaryFn getProgramBinary = nullptr;
+    ProgramBinaryFn programBinary = nullptr;
+    ProgramParameteriFn programParameteri = nullptr;
+    bool available = false;
+
+    void load() {
+        if (!glVersionAtLeast(4, 1) && !glHasExtension("GL_ARB_get_program_binary")) return;
+        getProgramBinary = reinterpret_cast<GetProgramBinaryFn>(glfwGetProcAddress("glGetProgramBinary"));
+        programBinary = reinterpret_cast<ProgramBinaryFn>(glfwGetProcAddress("glProgramBinary"));
+        programParameteri = reinterpret_cast<ProgramParameteriFn>(glfwGetProcAddress("glProgramParameteri"));
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        available = getProgramBinary && programBinary && programParameteri && formats > 0;
+    }
+};
+
+// KHR/ARB_parallel_shader_compile: compiles and links return immediately and
+// GL_COMPLETION_STATUS_KHR can be polled without blocking.
+struct GLParallelCompileAPI {
+    MaxShaderCompilerThreadsFn maxShaderCompilerThreads = nullptr;
+    bool available = false;
+
+    void load() {
+        if (glHasExtension("GL_KHR_parallel_shader_compile"))
+            maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsFn>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+        else if (glHasExtension("GL_ARB_parallel_shader_compile"))
+            maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsFn>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+        available = maxShaderCompilerThreads != nullptr;
+        if (available) maxShaderCompilerThreads(0xFFFFFFFFu); // let the driver pick
+    }
+};
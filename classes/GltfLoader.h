@@ -0,0 +1,357 @@
+#pragma once
+#include "Json.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GLTF_SSE2 1
+#endif
+
+struct GltfModel {
+    std::vector<Mesh> meshes;       // one per triangle primitive
+    std::vector<int> materials;     // glTF material index per mesh, -1 if none
+    std::vector<std::string> names; // owning glTF mesh name per mesh
+    size_t zeroCopyPrimitives = 0;  // uploaded straight from the mapped buffers
+    size_t convertedPrimitives = 0; // went through the interleave pass
+};
+
+// glTF 2.0 importer for .gltf (+ .bin / data URIs) and .glb. Buffers are
+// memory mapped; when an accessor layout is one Mesh can consume directly
+// (interleaved 8-float or tightly packed planar float streams) the mapped
+// bytes are handed to GL without touching them on the CPU. Anything else is
+// converted in a single interleaving pass.
+class GltfLoader {
+public:
+    static bool load(const std::string& path, GltfModel& out) {
+        out = GltfModel();
+        GltfLoader loader;
+        return loader.loadFile(path, out);
+    }
+
+private:
+    enum ComponentType {
+        BYTE = 5120, UNSIGNED_BYTE = 5121, SHORT = 5122,
+        UNSIGNED_SHORT = 5123, UNSIGNED_INT = 5125, FLOAT = 5126
+    };
+
+    struct Buffer {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    struct Accessor {
+        const uint8_t* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        int componentType = 0;
+        int components = 0;
+        bool normalized = false;
+        int bufferView = -1;
+        size_t viewOffset = 0; // accessor.byteOffset within its bufferView
+        bool valid() const { return data != nullptr; }
+        size_t elementSize() const { return components * componentSize(componentType); }
+        bool tightFloat(int n) const {
+            return componentType == FLOAT && components == n && stride == n * sizeof(float);
+        }
+    };
+
+    JsonValue json;
+    std::string directory;
+    std::vector<std::unique_ptr<MappedFile>> mappings;
+    std::vector<std::vector<uint8_t>> decoded;
+    std::vector<Buffer> buffers;
+
+    static size_t componentSize(int type) {
+        switch (type) {
+        case BYTE: case UNSIGNED_BYTE: return 1;
+        case SHORT: case UNSIGNED_SHORT: return 2;
+        default: return 4;
+        }
+    }
+
+    static int componentCount(const std::string& type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    static uint32_t readU32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+    bool loadFile(const std::string& path, GltfModel& out) {
+        size_t slash = path.find_last_of("/\\");
+        directory = (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+
+        mappings.emplace_back(new MappedFile());
+        MappedFile& file = *mappings.back();
+        if (!file.open(path.c_str(), false)) return false;
+
+        const uint8_t* data = file.data();
+        size_t size = file.size();
+        Buffer glbBinary;
+
+        if (size >= 12 && std::memcmp(data, "glTF", 4) == 0) {
+            if (readU32(data + 4) != 2) {
+                std::cout << "ERROR::GLTF::UNSUPPORTED_GLB_VERSION " << path << std::endl;
+                return false;
+            }
+            size_t total = std::min<size_t>(readU32(data + 8), size);
+            size_t offset = 12;
+            const uint8_t* jsonChunk = nullptr;
+            size_t jsonSize = 0;
+            while (offset + 8 <= total) {
+                uint32_t chunkLength = readU32(data + offset);
+                uint32_t chunkType = readU32(data + offset + 4);
+                const uint8_t* chunkData = data + offset + 8;
+                if (offset + 8 + chunkLength > total) break;
+                if (chunkType == 0x4E4F534A) { jsonChunk = chunkData; jsonSize = chunkLength; }      // "JSON"
+                else if (chunkType == 0x004E4942 && !glbBinary.data) glbBinary = { chunkData, chunkLength }; // "BIN\0"
+                offset += 8 + ((chunkLength + 3) & ~3u);
+            }
+            if (!jsonChunk || !JsonValue::parse(reinterpret_cast<const char*>(jsonChunk), jsonSize, json)) {
+                std::cout << "ERROR::GLTF::BAD_JSON_CHUNK " << path << std::endl;
+                return false;
+            }
+        } else if (!JsonValue::parse(reinterpret_cast<const char*>(data), size, json)) {
+            std::cout << "ERROR::GLTF::BAD_JSON " << path << std::endl;
+            return false;
+        }
+
+        if (!loadBuffers(glbBinary)) return false;
+
+        const JsonValue& meshes = json["meshes"];
+        for (size_t m = 0; m < meshes.size(); ++m) {
+            const JsonValue& primitives = meshes[m]["primitives"];
+            for (size_t p = 0; p < primitives.size(); ++p)
+                loadPrimitive(primitives[p], meshes[m]["name"].asString(), out);
+        }
+        return true;
+    }
+
+    bool loadBuffers(const Buffer& glbBinary) {
+        const JsonValue& list = json["buffers"];
+        for (size_t i = 0; i < list.size(); ++i) {
+            const JsonValue& b = list[i];
+            Buffer buffer;
+            if (!b.has("uri")) {
+                buffer = glbBinary; // GLB-stored buffer
+            } else {
+                const std::string& uri = b["uri"].asString();
+                if (uri.compare(0, 5, "data:") == 0) {
+                    size_t comma = uri.find(',');
+                    decoded.emplace_back();
+                    if (comma == std::string::npos || !decodeBase64(uri.c_str() + comma + 1, decoded.back())) {
+                        std::cout << "ERROR::GLTF::BAD_DATA_URI buffer " << i << std::endl;
+                        return false;
+                    }
+                    buffer = { decoded.back().data(), decoded.back().size() };
+                } else {
+                    mappings.emplace_back(new MappedFile());
+                    if (!mappings.back()->open((directory + uri).c_str(), false)) return false;
+                    buffer = { mappings.back()->data(), mappings.back()->size() };
+                }
+            }
+            size_t declared = static_cast<size_t>(b["byteLength"].asNumber());
+            if (!buffer.data || buffer.size < declared) {
+                std::cout << "ERROR::GLTF::BUFFER_TOO_SMALL buffer " << i << std::endl;
+                return false;
+            }
+            buffers.push_back(buffer);
+        }
+        return true;
+    }
+
+    Accessor accessor(int index) const {
+        Accessor a;
+        const JsonValue& acc = json["accessors"][index];
+        if (!acc.isObject() || !acc.has("bufferView") || acc.has("sparse")) return a;
+
+        const JsonValue& view = json["bufferViews"][acc["bufferView"].asInt()];
+        int bufferIndex = view["buffer"].asInt(-1);
+        if (bufferIndex < 0 || bufferIndex >= static_cast<int>(buffers.size())) return a;
+
+        a.componentType = acc["componentType"].asInt();
+        a.components = componentCount(acc["type"].asString());
+        a.normalized = acc["normalized"].asBool();
+        a.count = static_cast<size_t>(acc["count"].asNumber());
+        a.bufferView = acc["bufferView"].asInt();
+        a.viewOffset = static_cast<size_t>(acc["byteOffset"].asNumber());
+        a.stride = static_cast<size_t>(view["byteStride"].asNumber());
+        if (a.stride == 0) a.stride = a.elementSize();
+
+        size_t viewOffset = static_cast<size_t>(view["byteOffset"].asNumber());
+        size_t viewLength = static_cast<size_t>(view["byteLength"].asNumber());
+        const Buffer& buffer = buffers[bufferIndex];
+        size_t needed = a.count ? a.viewOffset + (a.count - 1) * a.stride + a.elementSize() : 0;
+        if (a.components == 0 || viewOffset + viewLength > buffer.size || needed > viewLength) return Accessor();
+
+        a.data = buffer.data + viewOffset + a.viewOffset;
+        return a;
+    }
+
+    void loadPrimitive(const JsonValue& primitive, const std::string& name, GltfModel& out) {
+        if (primitive["mode"].asInt(4) != 4) return; // triangles only
+
+        const JsonValue& attributes = primitive["attributes"];
+        Accessor pos = accessor(attributes["POSITION"].asInt(-1));
+        Accessor nrm = attributes.has("NORMAL") ? accessor(attributes["NORMAL"].asInt()) : Accessor();
+        Accessor uv  = attributes.has("TEXCOORD_0") ? accessor(attributes["TEXCOORD_0"].asInt()) : Accessor();
+        if (!pos.valid() || pos.componentType != FLOAT || pos.components != 3) {
+            std::cout << "ERROR::GLTF::UNSUPPORTED_POSITION_ACCESSOR in mesh " << name << std::endl;
+            return;
+        }
+        if (nrm.valid() && nrm.count != pos.count) nrm = Accessor();
+        if (uv.valid() && uv.count != pos.count) uv = Accessor();
+
+        MeshIndexSource indexSource;
+        std::vector<uint32_t> widenedIndices;
+        if (primitive.has("indices")) {
+            Accessor idx = accessor(primitive["indices"].asInt());
+            if (!idx.valid() || idx.components != 1) {
+                std::cout << "ERROR::GLTF::UNSUPPORTED_INDEX_ACCESSOR in mesh " << name << std::endl;
+                return;
+            }
+            indexSource.count = idx.count;
+            if (idx.stride == componentSize(idx.componentType) &&
+                (idx.componentType == UNSIGNED_BYTE || idx.componentType == UNSIGNED_SHORT ||
+                 idx.componentType == UNSIGNED_INT)) {
+                indexSource.data = idx.data;
+                indexSource.type = idx.componentType; // GL enums share the glTF values
+            } else {
+                widenedIndices.resize(idx.count);
+                for (size_t i = 0; i < idx.count; ++i) widenedIndices[i] = readIndex(idx, i);
+                indexSource.data = widenedIndices.data();
+                indexSource.type = GL_UNSIGNED_INT;
+            }
+        }
+
+        MeshVertexSource source;
+        source.vertexCount = pos.count;
+        std::vector<float> converted;
+
+        bool interleaved = nrm.valid() && uv.valid() &&
+                           pos.bufferView == nrm.bufferView && pos.bufferView == uv.bufferView &&
+                           pos.stride == 8 * sizeof(float) && nrm.stride == pos.stride && uv.stride == pos.stride &&
+                           nrm.componentType == FLOAT && nrm.components == 3 &&
+                           uv.componentType == FLOAT && uv.components == 2 &&
+                           nrm.viewOffset == pos.viewOffset + 3 * sizeof(float) &&
+                           uv.viewOffset == pos.viewOffset + 6 * sizeof(float);
+        bool planar = pos.tightFloat(3) &&
+                      (!nrm.valid() || nrm.tightFloat(3)) &&
+                      (!uv.valid() || uv.tightFloat(2));
+
+        if (interleaved) {
+            source.interleaved = pos.data;
+        } else if (planar) {
+            source.positions = pos.data;
+            source.normals = nrm.valid() ? nrm.data : nullptr;
+            source.texCoords = uv.valid() ? uv.data : nullptr;
+        } else {
+            convert(pos, nrm, uv, converted);
+            source.interleaved = converted.data();
+        }
+
+        out.meshes.emplace_back(source, indexSource);
+        out.materials.push_back(primitive["material"].asInt(-1));
+        out.names.push_back(name);
+        if (converted.empty()) ++out.zeroCopyPrimitives;
+        else ++out.convertedPrimitives;
+    }
+
+    static uint32_t readIndex(const Accessor& a, size_t i) {
+        const uint8_t* p = a.data + i * a.stride;
+        if (a.componentType == UNSIGNED_BYTE) return *p;
+        if (a.componentType == UNSIGNED_SHORT) { uint16_t v; std::memcpy(&v, p, 2); return v; }
+        uint32_t v; std::memcpy(&v, p, 4); return v;
+    }
+
+    // Reads one element as floats, applying glTF normalized-integer rules.
+    static void readFloats(const Accessor& a, size_t i, int n, float* dst) {
+        const uint8_t* p = a.data + i * a.stride;
+        for (int c = 0; c < n; ++c) {
+            if (c >= a.components) { dst[c] = 0.0f; continue; }
+            switch (a.componentType) {
+            case FLOAT: std::memcpy(&dst[c], p + c * 4, 4); break;
+            case UNSIGNED_BYTE: dst[c] = a.normalized ? p[c] / 255.0f : p[c]; break;
+            case BYTE: { float v = static_cast<int8_t>(p[c]); dst[c] = a.normalized ? std::max(v / 127.0f, -1.0f) : v; break; }
+            case UNSIGNED_SHORT: { uint16_t v; std::memcpy(&v, p + c * 2, 2); dst[c] = a.normalized ? v / 65535.0f : v; break; }
+            case SHORT: { int16_t v; std::memcpy(&v, p + c * 2, 2); dst[c] = a.normalized ? std::max(v / 32767.0f, -1.0f) : v; break; }
+            default: { uint32_t v; std::memcpy(&v, p + c * 4, 4); dst[c] = static_cast<float>(v); break; }
+            }
+        }
+    }
+
+    // Single pass into the 8-float Mesh layout. Float streams go through SSE
+    // (two 4-wide stores per vertex); quantized streams take the scalar path.
+    static void convert(const Accessor& pos, const Accessor& nrm, const Accessor& uv, std::vector<float>& out) {
+        size_t count = pos.count;
+        out.resize(count * 8);
+        float* dst = out.data();
+
+        bool floatNormals = !nrm.valid() || (nrm.componentType == FLOAT && nrm.components == 3);
+        bool floatUVs = !uv.valid() || (uv.componentType == FLOAT && uv.components == 2);
+        size_t i = 0;
+#ifdef GLTF_SSE2
+        if (floatNormals && floatUVs && count > 0) {
+            // the last vertex is finished scalar: 4-wide loads of a vec3 read
+            // one float past the element
+            for (; i + 1 < count; ++i) {
+                __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(pos.data + i * pos.stride));
+                __m128 b = nrm.valid()
+                    ? _mm_loadu_ps(reinterpret_cast<const float*>(nrm.data + i * nrm.stride))
+                    : _mm_setzero_ps();
+                __m128 t = uv.valid()
+                    ? _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(uv.data + i * uv.stride)))
+                    : _mm_setzero_ps();
+                __m128 pz_nx = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 2));
+                __m128 lo = _mm_shuffle_ps(a, pz_nx, _MM_SHUFFLE(2, 0, 1, 0)); // px py pz nx
+                __m128 hi = _mm_shuffle_ps(b, t, _MM_SHUFFLE(1, 0, 2, 1));     // ny nz u v
+                _mm_storeu_ps(dst + i * 8, lo);
+                _mm_storeu_ps(dst + i * 8 + 4, hi);
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            float* v = dst + i * 8;
+            readFloats(pos, i, 3, v);
+            if (nrm.valid()) readFloats(nrm, i, 3, v + 3);
+            else v[3] = v[4] = v[5] = 0.0f;
+            if (uv.valid()) readFloats(uv, i, 2, v + 6);
+            else v[6] = v[7] = 0.0f;
+        }
+    }
+
+    static bool decodeBase64(const char* in, std::vector<uint8_t>& out) {
+        auto value = [](char c) -> int {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+' || c == '-') return 62;
+            if (c == '/' || c == '_') return 63;
+            return -1;
+        };
+        uint32_t bits = 0;
+        int bitCount = 0;
+        for (; *in && *in != '='; ++in) {
+            int v = value(*in);
+            if (v < 0) return false;
+            bits = (bits << 6) | v;
+            bitCount += 6;
+            if (bitCount >= 8) {
+                bitCount -= 8;
+                out.push_back(static_cast<uint8_t>((bits >> bitCount) & 0xFF));
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <glad/glad.h>
+
+// Small ring of GL query objects (GL_TIME_ELAPSED, GL_SAMPLES_PASSED, ...)
+// read back a few frames late so fetching a result never stalls the
+// pipeline. value() holds the newest result that has arrived.
+//
+// GL_TIME_ELAPSED is measured with a pair of GL_TIMESTAMP counters instead
+// of a time-elapsed query: only one of those can be active at a time, so a
+// frame timer around a renderer with its own pass timers would fail the
+// inner begins and be ended early by them. Timestamp pairs nest freely.
+class GpuQueryRing {
+public:
+    static const int SIZE = 4;
+
+    void init(GLenum queryTarget) {
+        target = queryTarget;
+        timestamps = target == GL_TIME_ELAPSED;
+        glGenQueries(timestamps ? 2 * SIZE : SIZE, ids);
+    }
+
+    void begin() {
+        collect();
+        if (issued[head]) {
+            // ring wrapped before the GPU caught up: wait for the oldest
+            fetch(head);
+            issued[head] = false;
+            ready = true;
+        }
+        if (timestamps) glQueryCounter(ids[2 * head], GL_TIMESTAMP);
+        else glBeginQuery(target, ids[head]);
+    }
+
+    void end() {
+        if (timestamps) glQueryCounter(ids[2 * head + 1], GL_TIMESTAMP);
+        else glEndQuery(target);
+        issued[head] = true;
+        head = (head + 1) % SIZE;
+    }
+
+    // Picks up finished results, oldest first, without blocking. Returns
+    // true when at least one new result arrived.
+    bool collect() {
+        bool arrived = false;
+        for (int k = 0; k < SIZE; ++k) {
+            int i = (head + k) % SIZE;
+            if (!issued[i]) continue;
+            GLint available = GL_FALSE;
+            // the end timestamp is written after the begin one
+            glGetQueryObjectiv(timestamps ? ids[2 * i + 1] : ids[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+            fetch(i);
+            issued[i] = false;
+            ready = arrived = true;
+        }
+        return arrived;
+    }
+
+    bool hasValue() const { return ready; }
+    GLuint64 value() const { return latest; }
+    double milliseconds() const { return latest / 1.0e6; } // for GL_TIME_ELAPSED
+
+    void cleanUp() {
+        if (ids[0]) glDeleteQueries(timestamps ? 2 * SIZE : SIZE, ids);
+        for (int i = 0; i < 2 * SIZE; ++i) ids[i] = 0;
+        for (int i = 0; i < SIZE; ++i) issued[i] = false;
+    }
+
+private:
+    GLenum target = GL_TIME_ELAPSED;
+    bool timestamps = true;
+    GLuint ids[2 * SIZE] = {}; // begin/end pairs when timing, else one per slot
+    bool issued[SIZE] = {};
+    int head = 0;
+    GLuint64 latest = 0;
+    bool ready = false;
+
+    // Blocks until slot i's result is available.
+    void fetch(int i) {
+        if (!timestamps) {
+            glGetQueryObjectui64v(ids[i], GL_QUERY_RESULT, &latest);
+            return;
+        }
+        GLuint64 start = 0, stop = 0;
+        glGetQueryObjectui64v(ids[2 * i], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(ids[2 * i + 1], GL_QUERY_RESULT, &stop);
+        latest = stop > start ? stop - start : 0;
+    }
+};
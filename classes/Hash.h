@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+static const uint64_t FNV1A_SEED = 0xCBF29CE484222325ull;
+
+// FNV-1a, 64-bit. Hash several fields in sequence by passing the previous
+// result back in as the seed.
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t seed = FNV1A_SEED) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) { h ^= p[i]; h *= 0x100000001B3ull; }
+    return h;
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal DOM JSON reader, enough for asset metadata (glTF, manifests).
+// Objects keep their members in file order; lookups are linear, which is fine
+// for the small objects these formats use.
+class JsonValue {
+public:
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;                          // Array
+    std::vector<std::pair<std::string, JsonValue>> members; // Object
+
+    bool isNull() const { return type == Null; }
+    bool isObject() const { return type == Object; }
+    bool isArray() const { return type == Array; }
+    bool isNumber() const { return type == Number; }
+    bool isString() const { return type == String; }
+
+    size_t size() const { return type == Array ? items.size() : members.size(); }
+
+    const JsonValue& operator[](size_t i) const {
+        return (type == Array && i < items.size()) ? items[i] : nullValue();
+    }
+
+    const JsonValue& operator[](const char* key) const {
+        if (type == Object)
+            for (const auto& m : members)
+                if (m.first == key) return m.second;
+        return nullValue();
+    }
+
+    bool has(const char* key) const { return !(*this)[key].isNull(); }
+
+    double asNumber(double fallback = 0.0) const { return type == Number ? number : fallback; }
+    int asInt(int fallback = 0) const { return type == Number ? static_cast<int>(number) : fallback; }
+    bool asBool(bool fallback = false) const { return type == Bool ? boolean : fallback; }
+    const std::string& asString() const { static const std::string empty; return type == String ? string : empty; }
+
+    static bool parse(const char* text, size_t length, JsonValue& out) {
+        Parser p{ text, text + length };
+        p.skipSpace();
+        if (!p.value(out, 0)) return false;
+        p.skipSpace();
+        return p.cur == p.end || *p.cur == '\0';
+    }
+
+private:
+    static const JsonValue& nullValue() { static const JsonValue v; return v; }
+
+    struct Parser {
+        const char* cur;
+        const char* end;
+
+        void skipSpace() {
+            while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r')) ++cur;
+        }
+
+        bool literal(const char* word) {
+            size_t n = std::strlen(word);
+            if (static_cast<size_t>(end - cur) < n || std::strncmp(cur, word, n) != 0) return false;
+            cur += n;
+            return true;
+        }
+
+        bool value(JsonValue& v, int depth) {
+            if (cur >= end || depth > 256) return false;
+            switch (*cur) {
+            case '{': return object(v, depth);
+            case '[': return array(v, depth);
+            case '"': v.type = String; return str(v.string);
+            case 't': v.type = Bool; v.boolean = true; return literal("true");
+            case 'f': v.type = Bool; v.boolean = false; return literal("false");
+            case 'n': v.type = Null; return literal("null");
+            default: return num(v);
+            }
+        }
+
+        bool num(JsonValue& v) {
+            // strtod needs a terminator; numbers are short so copy them out
+            char buf[64];
+            size_t n = 0;
+            while (cur < end && n < sizeof(buf) - 1 &&
+                   (std::strchr("+-.eE", *cur) || (*cur >= '0' && *cur <= '9')))
+                buf[n++] = *cur++;
+            if (n == 0) return false;
+            buf[n] = '\0';
+            char* stop = nullptr;
+            v.type = Number;
+            v.number = std::strtod(buf, &stop);
+            return stop == buf + n;
+        }
+
+        static void appendUtf8(std::string& s, unsigned int cp) {
+            if (cp < 0x80) s += static_cast<char>(cp);
+            else if (cp < 0x800) { s += static_cast<char>(0xC0 | (cp >> 6)); s += static_cast<char>(0x80 | (cp & 0x3F)); }
+            else if (cp < 0x10000) {
+                s += static_cast<char>(0xE0 | (cp >> 12));
+                s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                s += static_cast<char>(0x80 | (cp & 0x3F));
+            } else {
+                s += static_cast<char>(0xF0 | (cp >> 18));
+                s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                s += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+        bool hex4(unsigned int& cp) {
+            if (end - cur < 4) return false;
+            cp = 0;
+            for (int i = 0; i < 4; ++i) {
+                char c = *cur++;
+                cp <<= 4;
+                if (c >= '0' && c <= '9') cp |= c - '0';
+                else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+                else return false;
+            }
+            return true;
+        }
+
+        bool str(std::string& s) {
+            ++cur; // opening quote
+            while (cur < end && *cur != '"') {
+                if (*cur != '\\') { s += *cur++; continue; }
+                if (++cur >= end) return false;
+                char c = *cur++;
+                switch (c) {
+                case 'n': s += '\n'; break;
+                case 't': s += '\t'; break;
+                case 'r': s += '\r'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'u': {
+                    unsigned int cp;
+                    if (!hex4(cp)) return false;
+                    if (cp >= 0xD800 && cp < 0xDC00 && end - cur >= 6 && cur[0] == '\\' && cur[1] == 'u') {
+                        cur += 2;
+                        unsigned int lo;
+                        if (!hex4(lo)) return false;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    }
+                    appendUtf8(s, cp);
+                    break;
+                }
+                default: s += c; break; // \" \\ \/
+                }
+            }
+            if (cur >= end) return false;
+            ++cur;
+            return true;
+        }
+
+        bool array(JsonValue& v, int depth) {
+            v.type = Array;
+            ++cur;
+            skipSpace();
+            if (cur < end && *cur == ']') { ++cur; return true; }
+            while (cur < end) {
+                v.items.emplace_back();
+                skipSpace();
+                if (!value(v.items.back(), depth + 1)) return false;
+                skipSpace();
+                if (cur < end && *cur == ',') { ++cur; continue; }
+                if (cur < end && *cur == ']') { ++cur; return true; }
+                return false;
+            }
+            return false;
+        }
+
+        bool object(JsonValue& v, int depth) {
+            v.type = Object;
+            ++cur;
+            skipSpace();
+            if (cur < end && *cur == '}') { ++cur; return true; }
+            while (cur < end) {
+                skipSpace();
+                if (cur >= end || *cur != '"') return false;
+                v.members.emplace_back();
+                if (!str(v.members.back().first)) return false;
+                skipSpace();
+                if (cur >= end || *cur != ':') return false;
+                ++cur;
+                skipSpace();
+                if (!value(v.members.back().second, depth + 1)) return false;
+                skipSpace();
+                if (cur < end && *cur == ',') { ++cur; continue; }
+                if (cur < end && *cur == '}') { ++cur; return true; }
+                return false;
+            }
+            return false;
+        }
+    };
+};
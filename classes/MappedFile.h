@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file. The page cache backs the data, so
+// loaders can parse straight out of it without a read() copy.
+class MappedFile {
+public:
+    MappedFile() {}
+    explicit MappedFile(const char* path, bool sequential = true) { open(path, sequential); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            ptr = other.ptr; length = other.length;
+#ifdef _WIN32
+            file = other.file; mapping = other.mapping;
+            other.file = INVALID_HANDLE_VALUE; other.mapping = NULL;
+#endif
+            other.ptr = nullptr; other.length = 0;
+        }
+        return *this;
+    }
+
+    // sequential hints read-ahead for front-to-back parsers; pass false for
+    // random access (archives, glTF buffers).
+    bool open(const char* path, bool sequential = true) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                           sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length == 0) return true;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) ptr = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        length = static_cast<size_t>(st.st_size);
+        if (length == 0) { ::close(fd); return true; }
+        void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps its own reference to the file
+        if (p != MAP_FAILED) {
+            ptr = static_cast<const uint8_t*>(p);
+            madvise(p, length, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        }
+#endif
+        if (!ptr) {
+            std::cout << "ERROR::MAPPED_FILE::MAP_FAILED " << path << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (ptr) UnmapViewOfFile(ptr);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL; file = INVALID_HANDLE_VALUE;
+#else
+        if (ptr) munmap(const_cast<uint8_t*>(ptr), length);
+#endif
+        ptr = nullptr;
+        length = 0;
+    }
+
+    const uint8_t* data() const { return ptr; }
+    size_t size() const { return length; }
+    bool isOpen() const { return ptr != nullptr; }
+
+private:
+    const uint8_t* ptr = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include "Shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+struct Material {
+    glm::vec3 Color = glm::vec3(1.0f);
+    float SpecularStrength = 0.5f;
+    float Shininess = 32.0f;
+};
+
+// All materials live in one std140 uniform block ("Materials" in
+// shaders/phong.frag) written once at load. A draw selects its material with
+// the materialIndex uniform, an instanced draw with the per-instance
+// aMaterialIndex attribute, so changing material is an index change rather
+// than a set of glUniform calls.
+class MaterialLibrary {
+public:
+    static const unsigned int MAX_MATERIALS = 256;  // keep in sync with phong.frag
+    static const unsigned int BINDING_POINT = 0;
+    static const unsigned int INSTANCE_ATTRIBUTE = 7; // after the instance mat4 at 3-6
+
+    unsigned int ubo = 0;
+
+    int add(const Material& material) {
+        if (materials.size() >= MAX_MATERIALS) {
+            std::cout << "ERROR::MATERIAL_LIBRARY::TOO_MANY_MATERIALS" << std::endl;
+            return 0;
+        }
+        materials.push_back(material);
+        if (ubo) update(static_cast<int>(materials.size() - 1), material);
+        return static_cast<int>(materials.size() - 1);
+    }
+
+    const Material& get(int index) const { return materials[index]; }
+    size_t size() const { return materials.size(); }
+
+    // Writes the whole table and binds it; call after loading materials.
+    void upload() {
+        std::vector<GpuMaterial> data(MAX_MATERIALS);
+        for (size_t i = 0; i < materials.size(); ++i) data[i] = pack(materials[i]);
+
+        if (!ubo) glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, data.size() * sizeof(GpuMaterial), data.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, ubo);
+    }
+
+    // Edits one entry in place (editor tweaks, fades); the rest stay untouched.
+    void update(int index, const Material& material) {
+        materials[index] = material;
+        if (!ubo) return;
+        GpuMaterial m = pack(material);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, index * sizeof(GpuMaterial), sizeof(GpuMaterial), &m);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // GLSL 3.30 has no layout(binding), so each program's block is pointed
+    // at the binding point once.
+    void bind(const Shader& shader) {
+        if (!bound.insert(shader.programID).second) return;
+        unsigned int block = glGetUniformBlockIndex(shader.programID, "Materials");
+        if (block != GL_INVALID_INDEX) glUniformBlockBinding(shader.programID, block, BINDING_POINT);
+    }
+
+    // Per-instance material indices for instanced draws. The buffer must be
+    // bound to GL_ARRAY_BUFFER while the mesh VAO is bound.
+    static void setupInstanceAttribute(unsigned int instanceBuffer, GLsizei stride = sizeof(int), size_t offset = 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glVertexAttribIPointer(INSTANCE_ATTRIBUTE, 1, GL_INT, stride, (void*)offset);
+        glEnableVertexAttribArray(INSTANCE_ATTRIBUTE);
+        glVertexAttribDivisor(INSTANCE_ATTRIBUTE, 1);
+    }
+
+    void cleanUp() {
+        if (ubo) glDeleteBuffers(1, &ubo);
+        ubo = 0;
+        bound.clear();
+    }
+
+private:
+    // std140: two vec4s, 32 bytes per array element
+    struct GpuMaterial {
+        float colorSpecular[4]; // rgb colour, specular strength
+        float params[4];        // shininess, unused x3
+    };
+
+    std::vector<Material> materials;
+    std::unordered_set<unsigned int> bound;
+
+    static GpuMaterial pack(const Material& m) {
+        GpuMaterial g = {};
+        g.colorSpecular[0] = m.Color.x;
+        g.colorSpecular[1] = m.Color.y;
+        g.colorSpecular[2] = m.Color.z;
+        g.colorSpecular[3] = m.SpecularStrength;
+        g.params[0] = m.Shininess;
+        return g;
+    }
+};
@@ -1,53 +1,111 @@
+#pragma once
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <vector>
 #include <iostream>
 
+// Caller-owned vertex data uploaded straight to the GPU (e.g. a mapped glTF
+// buffer view). Either one interleaved stream in the 8-float Mesh layout, or
+// up to three tightly packed planar streams; a missing normal/uv stream
+// leaves that attribute at its constant default.
+struct MeshVertexSource {
+    const void* interleaved = nullptr;
+    const void* positions = nullptr;
+    const void* normals = nullptr;
+    const void* texCoords = nullptr;
+    size_t vertexCount = 0;
+};
+
+struct MeshIndexSource {
+    const void* data = nullptr;
+    size_t count = 0;
+    GLenum type = GL_UNSIGNED_INT; // GL_UNSIGNED_BYTE / SHORT / INT
+};
+
 class Mesh {
 public:
-    unsigned int VAO, VBO, EBO;
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    unsigned int depthVAO = 0; // position-only view of VBO for depth passes
     std::vector<float> vertices;
     std::vector<unsigned int> indices; // Only used for indexed drawing
-    unsigned int texture;
+    unsigned int texture = 0;
+    GLsizei vertexCount = 0;
+    GLsizei indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
 
     // Non-indexed constructor
     Mesh(const std::vector<float>& verts)
-        : vertices(verts) 
+        : vertices(verts),
+          vertexCount(static_cast<GLsizei>(verts.size() / 8))
     {
         setupMeshNonIndexed();
     }
 
     // Indexed constructor
     Mesh(const std::vector<float>& verts, const std::vector<unsigned int>& inds)
-        : vertices(verts), indices(inds) 
+        : vertices(verts), indices(inds),
+          vertexCount(static_cast<GLsizei>(verts.size() / 8)),
+          indexCount(static_cast<GLsizei>(inds.size()))
     {
         setupMeshIndexed();
     }
 
+    // Zero-copy constructor: no CPU-side vertex/index vectors are kept
+    Mesh(const MeshVertexSource& source, const MeshIndexSource& indexSource = MeshIndexSource())
+        : vertexCount(static_cast<GLsizei>(source.vertexCount)),
+          indexCount(static_cast<GLsizei>(indexSource.count)),
+          indexType(indexSource.type)
+    {
+        setupMeshFromSource(source, indexSource);
+    }
+
     void Draw(bool useIndexed = false) {
         glBindTexture(GL_TEXTURE_2D, texture);
         glBindVertexArray(VAO);
+        // constant attribute values are context state, not VAO state, so
+        // anything drawn since may have changed them
+        if (constantNormal) glVertexAttrib3f(1, 0.0f, 0.0f, 1.0f);
+        if (constantTexCoord) glVertexAttrib2f(2, 0.0f, 0.0f);
 
         if (useIndexed) {
             // Indexed drawing
-            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+            glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
         } else {
             // Non-indexed drawing
-            glDrawArrays(GL_TRIANGLES, 0, vertices.size() / 8); // 8 floats per vertex
+            glDrawArrays(GL_TRIANGLES, 0, vertexCount);
         }
 
         glBindVertexArray(0);
     }
 
+    // Depth-only draw (shadow maps, prepass): only the position attribute is
+    // enabled so the vertex fetch skips normals and uvs.
+    void DrawDepth(bool useIndexed = false) {
+        if (!depthVAO) setupDepthVAO();
+        glBindVertexArray(depthVAO);
+        if (useIndexed)
+            glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+        else
+            glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glBindVertexArray(0);
+    }
+
     void cleanUp() {
         glDeleteVertexArrays(1, &VAO);
+        if (depthVAO)
+            glDeleteVertexArrays(1, &depthVAO);
         glDeleteBuffers(1, &VBO);
-        if (!indices.empty())
+        if (EBO)
             glDeleteBuffers(1, &EBO);
         glDeleteTextures(1, &texture);
     }
 
 private:
+    bool planar = false;
+    bool constantNormal = false;   // planar source without normals
+    bool constantTexCoord = false; // planar source without uvs
+
     void setupMeshNonIndexed() {
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
@@ -79,6 +137,66 @@ private:
         glBindVertexArray(0);
     }
 
+    void setupMeshFromSource(const MeshVertexSource& source, const MeshIndexSource& indexSource) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+        size_t count = source.vertexCount;
+        if (source.interleaved) {
+            glBufferData(GL_ARRAY_BUFFER, count * 8 * sizeof(float), source.interleaved, GL_STATIC_DRAW);
+            setupVertexAttributes();
+        } else {
+            // planar streams packed back to back in one buffer
+            planar = true;
+            size_t posBytes = count * 3 * sizeof(float);
+            size_t nrmBytes = source.normals ? count * 3 * sizeof(float) : 0;
+            size_t uvBytes  = source.texCoords ? count * 2 * sizeof(float) : 0;
+            glBufferData(GL_ARRAY_BUFFER, posBytes + nrmBytes + uvBytes, NULL, GL_STATIC_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, posBytes, source.positions);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+
+            if (source.normals) {
+                glBufferSubData(GL_ARRAY_BUFFER, posBytes, nrmBytes, source.normals);
+                glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)posBytes);
+                glEnableVertexAttribArray(1);
+            } else {
+                constantNormal = true; // set per draw
+            }
+
+            if (source.texCoords) {
+                glBufferSubData(GL_ARRAY_BUFFER, posBytes + nrmBytes, uvBytes, source.texCoords);
+                glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)(posBytes + nrmBytes));
+                glEnableVertexAttribArray(2);
+            } else {
+                constantTexCoord = true;
+            }
+        }
+
+        if (indexSource.data && indexSource.count) {
+            size_t indexSize = indexSource.type == GL_UNSIGNED_BYTE ? 1 :
+                               indexSource.type == GL_UNSIGNED_SHORT ? 2 : 4;
+            glGenBuffers(1, &EBO);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSource.count * indexSize, indexSource.data, GL_STATIC_DRAW);
+        }
+        glBindVertexArray(0);
+    }
+
+    void setupDepthVAO() {
+        // planar sources keep positions tightly packed at the start of VBO
+        GLsizei stride = planar ? 3 * sizeof(float) : 8 * sizeof(float);
+        glGenVertexArrays(1, &depthVAO);
+        glBindVertexArray(depthVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glEnableVertexAttribArray(0);
+        if (EBO) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBindVertexArray(0);
+    }
+
     void setupVertexAttributes() {
         // Position
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
@@ -0,0 +1,106 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NORMAL_MATRIX_SSE2 1
+#endif
+
+// Normal matrices (inverse-transpose of the upper 3x3 of a model matrix)
+// computed once per object on the CPU instead of once per vertex in the
+// shader. The inverse-transpose of a 3x3 with columns a, b, c is
+// [b x c, c x a, a x b] / det, which vectorises well across four matrices.
+enum TransformKind {
+    TRANSFORM_GENERAL,        // any invertible affine transform
+    TRANSFORM_UNIFORM_SCALE,  // rotation * uniform scale: M / s^2
+    TRANSFORM_RIGID,          // rotation only: the 3x3 itself
+};
+
+// Instanced draws read the matrix from attribute locations 8-10, after the
+// instance model matrix (3-6) and material index (7).
+static const unsigned int NORMAL_MATRIX_ATTRIBUTE = 8;
+
+inline glm::mat3 normalMatrix(const glm::mat4& model, TransformKind kind = TRANSFORM_GENERAL) {
+    glm::vec3 a(model[0]), b(model[1]), c(model[2]);
+    if (kind == TRANSFORM_RIGID) return glm::mat3(a, b, c);
+    if (kind == TRANSFORM_UNIFORM_SCALE) {
+        float inv = 1.0f / glm::dot(a, a);
+        return glm::mat3(a * inv, b * inv, c * inv);
+    }
+    glm::vec3 bc = glm::cross(b, c), ca = glm::cross(c, a), ab = glm::cross(a, b);
+    float invDet = 1.0f / glm::dot(a, bc);
+    return glm::mat3(bc * invDet, ca * invDet, ab * invDet);
+}
+
+// Batch version; out[i] is written as a column-major mat3 (9 floats), ready
+// for glUniformMatrix3fv or an instance buffer.
+inline void computeNormalMatrices(const glm::mat4* models, glm::mat3* out, size_t count,
+                                  TransformKind kind = TRANSFORM_GENERAL) {
+    size_t i = 0;
+#ifdef NORMAL_MATRIX_SSE2
+    if (kind == TRANSFORM_GENERAL) {
+        for (; i + 4 <= count; i += 4) {
+            // transpose four upper-left 3x3 blocks into SoA: m[col*3+row]
+            __m128 m[9];
+            for (int col = 0; col < 3; ++col)
+                for (int row = 0; row < 3; ++row)
+                    m[col * 3 + row] = _mm_set_ps(models[i + 3][col][row], models[i + 2][col][row],
+                                                  models[i + 1][col][row], models[i][col][row]);
+            const __m128 *a = m, *b = m + 3, *c = m + 6;
+            __m128 r[9];
+            // b x c, c x a, a x b
+            const __m128* lhs[3] = { b, c, a };
+            const __m128* rhs[3] = { c, a, b };
+            for (int k = 0; k < 3; ++k) {
+                const __m128* u = lhs[k];
+                const __m128* v = rhs[k];
+                r[k * 3 + 0] = _mm_sub_ps(_mm_mul_ps(u[1], v[2]), _mm_mul_ps(u[2], v[1]));
+                r[k * 3 + 1] = _mm_sub_ps(_mm_mul_ps(u[2], v[0]), _mm_mul_ps(u[0], v[2]));
+                r[k * 3 + 2] = _mm_sub_ps(_mm_mul_ps(u[0], v[1]), _mm_mul_ps(u[1], v[0]));
+            }
+            __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], r[0]), _mm_mul_ps(a[1], r[1])),
+                                    _mm_mul_ps(a[2], r[2]));
+            __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+            alignas(16) float lanes[9][4];
+            for (int e = 0; e < 9; ++e) _mm_store_ps(lanes[e], _mm_mul_ps(r[e], invDet));
+            for (int l = 0; l < 4; ++l) {
+                float* dst = &out[i + l][0][0];
+                for (int e = 0; e < 9; ++e) dst[e] = lanes[e][l];
+            }
+        }
+    } else if (kind == TRANSFORM_UNIFORM_SCALE) {
+        for (; i + 4 <= count; i += 4) {
+            __m128 a[3];
+            for (int row = 0; row < 3; ++row)
+                a[row] = _mm_set_ps(models[i + 3][0][row], models[i + 2][0][row],
+                                    models[i + 1][0][row], models[i][0][row]);
+            __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], a[0]), _mm_mul_ps(a[1], a[1])),
+                                     _mm_mul_ps(a[2], a[2]));
+            alignas(16) float inv[4];
+            _mm_store_ps(inv, _mm_div_ps(_mm_set1_ps(1.0f), len2));
+            for (int l = 0; l < 4; ++l) {
+                const glm::mat4& src = models[i + l];
+                float s = inv[l];
+                out[i + l] = glm::mat3(glm::vec3(src[0]) * s, glm::vec3(src[1]) * s, glm::vec3(src[2]) * s);
+            }
+        }
+    }
+#endif
+    for (; i < count; ++i) out[i] = normalMatrix(models[i], kind);
+}
+
+// Per-instance normal matrices for instanced draws (mat3 = three vec3
+// attributes). The buffer must be bound while the mesh VAO is bound.
+inline void setupInstanceNormalMatrix(unsigned int instanceBuffer, GLsizei stride = sizeof(glm::mat3), size_t offset = 0) {
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (unsigned int col = 0; col < 3; ++col) {
+        unsigned int location = NORMAL_MATRIX_ATTRIBUTE + col;
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, (void*)(offset + col * 3 * sizeof(float)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
@@ -0,0 +1,329 @@
+#pragma once
+#include "MappedFile.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Interleaved output in the layout Mesh expects: position(3) normal(3) uv(2).
+struct ObjMeshData {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    bool hasNormals = false;
+    bool hasTexCoords = false;
+};
+
+// Wavefront OBJ loader for static geometry. The file is mmapped, split into
+// line-aligned chunks parsed on separate threads, then merged and welded so
+// identical v/vt/vn triplets share one index.
+class ObjLoader {
+public:
+    static bool load(const char* path, ObjMeshData& out, unsigned int threadCount = 0) {
+        // an empty file maps to nothing but is still a valid (empty) mesh
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cout << "ERROR::OBJ_LOADER::FAILED_TO_OPEN " << path << std::endl;
+            return false;
+        }
+        return parse(reinterpret_cast<const char*>(file.data()), file.size(), out, threadCount);
+    }
+
+    // Needs a current context. out is left untouched on failure.
+    static bool loadMesh(const char* path, std::unique_ptr<Mesh>& out, unsigned int threadCount = 0) {
+        ObjMeshData data;
+        if (!load(path, data, threadCount)) return false;
+        if (data.indices.empty()) {
+            std::cout << "ERROR::OBJ_LOADER::NO_FACES " << path << std::endl;
+            return false;
+        }
+        out.reset(new Mesh(data.vertices, data.indices));
+        return true;
+    }
+
+    static bool parse(const char* text, size_t size, ObjMeshData& out, unsigned int threadCount = 0) {
+        out = ObjMeshData();
+
+        // split on line boundaries; small files are not worth the thread spawn
+        const size_t minChunkBytes = 1 << 20;
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        size_t chunkCount = std::min<size_t>(threadCount, std::max<size_t>(1, size / minChunkBytes));
+
+        std::vector<const char*> bounds(chunkCount + 1);
+        bounds[0] = text;
+        bounds[chunkCount] = text + size;
+        for (size_t i = 1; i < chunkCount; ++i) {
+            const char* p = text + size * i / chunkCount;
+            if (p < bounds[i - 1]) p = bounds[i - 1];
+            while (p < text + size && *p != '\n') ++p;
+            bounds[i] = (p < text + size) ? p + 1 : p;
+        }
+
+        std::vector<Chunk> chunks(chunkCount);
+        if (chunkCount == 1) {
+            parseChunk(bounds[0], bounds[1], chunks[0]);
+        } else {
+            std::vector<std::thread> workers;
+            for (size_t i = 0; i < chunkCount; ++i)
+                workers.emplace_back(parseChunk, bounds[i], bounds[i + 1], std::ref(chunks[i]));
+            for (auto& w : workers) w.join();
+        }
+
+        // global offsets of each chunk's v/vt/vn so chunk-relative indices resolve
+        std::vector<int> posBase(chunkCount), uvBase(chunkCount), nrmBase(chunkCount);
+        int posCount = 0, uvCount = 0, nrmCount = 0;
+        size_t cornerCount = 0;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            posBase[i] = posCount; uvBase[i] = uvCount; nrmBase[i] = nrmCount;
+            posCount += static_cast<int>(chunks[i].positions.size() / 3);
+            uvCount  += static_cast<int>(chunks[i].texCoords.size() / 2);
+            nrmCount += static_cast<int>(chunks[i].normals.size() / 3);
+            cornerCount += chunks[i].corners.size();
+        }
+
+        std::vector<float> positions, texCoords, normals;
+        positions.reserve(posCount * 3); texCoords.reserve(uvCount * 2); normals.reserve(nrmCount * 3);
+        for (auto& c : chunks) {
+            positions.insert(positions.end(), c.positions.begin(), c.positions.end());
+            texCoords.insert(texCoords.end(), c.texCoords.begin(), c.texCoords.end());
+            normals.insert(normals.end(), c.normals.begin(), c.normals.end());
+        }
+        out.hasNormals = nrmCount > 0;
+        out.hasTexCoords = uvCount > 0;
+
+        // weld identical corners with an open-addressing table
+        size_t tableSize = 16;
+        while (tableSize < cornerCount * 2) tableSize <<= 1;
+        std::vector<WeldSlot> table(tableSize);
+        std::vector<Corner> unique;
+        unique.reserve(cornerCount / 2 + 1);
+        out.indices.reserve(cornerCount);
+
+        for (size_t ci = 0; ci < chunkCount; ++ci) {
+            for (const Corner& raw : chunks[ci].corners) {
+                Corner c;
+                c.v = resolve(raw.v, raw.relative & REL_V, posBase[ci], posCount);
+                c.t = resolve(raw.t, raw.relative & REL_T, uvBase[ci], uvCount);
+                c.n = resolve(raw.n, raw.relative & REL_N, nrmBase[ci], nrmCount);
+                if (c.v < 0) {
+                    std::cout << "ERROR::OBJ_LOADER::BAD_FACE_INDEX" << std::endl;
+                    out = ObjMeshData();
+                    return false;
+                }
+
+                size_t slot = hashCorner(c) & (tableSize - 1);
+                while (true) {
+                    WeldSlot& s = table[slot];
+                    if (s.index == EMPTY) {
+                        s.key = c;
+                        s.index = static_cast<unsigned int>(unique.size());
+                        unique.push_back(c);
+                        out.indices.push_back(s.index);
+                        break;
+                    }
+                    if (s.key.v == c.v && s.key.t == c.t && s.key.n == c.n) {
+                        out.indices.push_back(s.index);
+                        break;
+                    }
+                    slot = (slot + 1) & (tableSize - 1);
+                }
+            }
+        }
+
+        out.vertices.resize(unique.size() * 8);
+        // corners without a vn index get face-averaged normals, even in files
+        // that give other faces theirs
+        std::vector<char> missingNormal(unique.size(), 0);
+        bool anyMissing = false;
+        for (size_t i = 0; i < unique.size(); ++i) {
+            const Corner& c = unique[i];
+            float* dst = &out.vertices[i * 8];
+            std::memcpy(dst, &positions[c.v * 3], 3 * sizeof(float));
+            if (c.n >= 0) std::memcpy(dst + 3, &normals[c.n * 3], 3 * sizeof(float));
+            else { dst[3] = dst[4] = dst[5] = 0.0f; missingNormal[i] = 1; anyMissing = true; }
+            if (c.t >= 0) std::memcpy(dst + 6, &texCoords[c.t * 2], 2 * sizeof(float));
+            else dst[6] = dst[7] = 0.0f;
+        }
+
+        if (anyMissing) generateNormals(out, missingNormal);
+        return true;
+    }
+
+    // Hand-rolled decimal parser; avoids the locale and stream overhead of
+    // strtof/sscanf, which dominate load time on large scans.
+    static const char* parseFloat(const char* p, const char* end, float& value) {
+        static const double powers[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) { negative = (*p == '-'); ++p; }
+
+        uint64_t mantissa = 0;
+        int exponent = 0, digits = 0;
+        while (p < end && isDigit(*p)) {
+            if (digits < 19) { mantissa = mantissa * 10 + (*p - '0'); ++digits; }
+            else ++exponent;
+            ++p;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            while (p < end && isDigit(*p)) {
+                if (mantissa == 0 && *p == '0') --exponent; // leading zeros cost no precision
+                else if (digits < 19) { mantissa = mantissa * 10 + (*p - '0'); ++digits; --exponent; }
+                ++p;
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool expNegative = false;
+            if (p < end && (*p == '-' || *p == '+')) { expNegative = (*p == '-'); ++p; }
+            int e = 0;
+            while (p < end && isDigit(*p)) { if (e < 1000) e = e * 10 + (*p - '0'); ++p; }
+            exponent += expNegative ? -e : e;
+        }
+
+        double result = static_cast<double>(mantissa);
+        while (exponent > 22) { result *= 1e22; exponent -= 22; }
+        while (exponent < -22) { result /= 1e22; exponent += 22; }
+        result = exponent >= 0 ? result * powers[exponent] : result / powers[-exponent];
+        value = static_cast<float>(negative ? -result : result);
+        return p;
+    }
+
+private:
+    static const unsigned int EMPTY = 0xFFFFFFFFu;
+
+    // Indices as written in a chunk: absolute 1-based, 0 = absent. Negative OBJ
+    // indices are stored as a chunk-local 0-based slot with the matching
+    // relative bit set, since the chunk does not know its global offset yet.
+    enum { REL_V = 1, REL_T = 2, REL_N = 4 };
+    struct Corner { int v = 0, t = 0, n = 0; unsigned int relative = 0; };
+    struct WeldSlot { Corner key; unsigned int index = EMPTY; };
+
+    struct Chunk {
+        std::vector<float> positions, texCoords, normals;
+        std::vector<Corner> corners; // triangulated, three per triangle
+    };
+
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static int resolve(int raw, bool relative, int base, int count) {
+        int index = -1;
+        if (relative) index = base + raw;
+        else if (raw > 0) index = raw - 1;
+        return (index >= 0 && index < count) ? index : -1;
+    }
+
+    static size_t hashCorner(const Corner& c) {
+        uint64_t h = static_cast<uint32_t>(c.v) * 0x9E3779B97F4A7C15ull;
+        h ^= (static_cast<uint32_t>(c.t) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2));
+        h ^= (static_cast<uint32_t>(c.n) * 0xC2B2AE3D27D4EB4Full) + (h << 6) + (h >> 2);
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    static const char* parseIndex(const char* p, const char* end, int localCount,
+                                  int& index, unsigned int& relative, unsigned int relBit) {
+        bool negative = false;
+        if (p < end && *p == '-') { negative = true; ++p; }
+        int value = 0;
+        while (p < end && isDigit(*p)) { value = value * 10 + (*p - '0'); ++p; }
+        if (negative && value != 0) { index = localCount - value; relative |= relBit; }
+        else index = value;
+        return p;
+    }
+
+    static void parseChunk(const char* p, const char* end, Chunk& chunk) {
+        std::vector<Corner> polygon;
+        while (p < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!lineEnd) lineEnd = end;
+
+            while (p < lineEnd && (*p == ' ' || *p == '\t')) ++p;
+            if (p + 1 < lineEnd && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+                float x, y, z;
+                p = parseFloat(p + 1, lineEnd, x);
+                p = parseFloat(p, lineEnd, y);
+                p = parseFloat(p, lineEnd, z);
+                chunk.positions.push_back(x);
+                chunk.positions.push_back(y);
+                chunk.positions.push_back(z);
+            } else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+                float u, v;
+                p = parseFloat(p + 2, lineEnd, u);
+                p = parseFloat(p, lineEnd, v);
+                chunk.texCoords.push_back(u);
+                chunk.texCoords.push_back(v);
+            } else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+                float x, y, z;
+                p = parseFloat(p + 2, lineEnd, x);
+                p = parseFloat(p, lineEnd, y);
+                p = parseFloat(p, lineEnd, z);
+                chunk.normals.push_back(x);
+                chunk.normals.push_back(y);
+                chunk.normals.push_back(z);
+            } else if (p + 1 < lineEnd && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+                int localPos = static_cast<int>(chunk.positions.size() / 3);
+                int localUv  = static_cast<int>(chunk.texCoords.size() / 2);
+                int localNrm = static_cast<int>(chunk.normals.size() / 3);
+
+                polygon.clear();
+                ++p;
+                while (true) {
+                    while (p < lineEnd && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+                    if (p >= lineEnd || !(isDigit(*p) || *p == '-')) break;
+                    Corner c;
+                    p = parseIndex(p, lineEnd, localPos, c.v, c.relative, REL_V);
+                    if (p < lineEnd && *p == '/') {
+                        ++p;
+                        if (p < lineEnd && *p != '/') p = parseIndex(p, lineEnd, localUv, c.t, c.relative, REL_T);
+                        if (p < lineEnd && *p == '/') p = parseIndex(p + 1, lineEnd, localNrm, c.n, c.relative, REL_N);
+                    }
+                    polygon.push_back(c);
+                }
+                // fan triangulation; OBJ polygons are expected to be convex
+                for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+                    chunk.corners.push_back(polygon[0]);
+                    chunk.corners.push_back(polygon[i]);
+                    chunk.corners.push_back(polygon[i + 1]);
+                }
+            }
+            p = lineEnd + 1;
+        }
+    }
+
+    // Area-weighted smooth normals over the welded vertices.
+    // Only the vertices flagged in missing are written.
+    static void generateNormals(ObjMeshData& data, const std::vector<char>& missing) {
+        std::vector<float>& v = data.vertices;
+        for (size_t i = 0; i + 2 < data.indices.size(); i += 3) {
+            unsigned int ia = data.indices[i], ib = data.indices[i + 1], ic = data.indices[i + 2];
+            if (!missing[ia] && !missing[ib] && !missing[ic]) continue;
+            float* a = &v[ia * 8];
+            float* b = &v[ib * 8];
+            float* c = &v[ic * 8];
+            float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1],
+                           e1[2] * e2[0] - e1[0] * e2[2],
+                           e1[0] * e2[1] - e1[1] * e2[0] };
+            for (int k = 0; k < 3; ++k) {
+                if (missing[ia]) a[3 + k] += n[k];
+                if (missing[ib]) b[3 + k] += n[k];
+                if (missing[ic]) c[3 + k] += n[k];
+            }
+        }
+        for (size_t i = 0; i < v.size(); i += 8) {
+            if (!missing[i / 8]) continue;
+            float len = std::sqrt(v[i + 3] * v[i + 3] + v[i + 4] * v[i + 4] + v[i + 5] * v[i + 5]);
+            if (len > 0.0f) { v[i + 3] /= len; v[i + 4] /= len; v[i + 5] /= len; }
+        }
+    }
+};
@@ -0,0 +1,327 @@
+#pragma once
+#include "Hash.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifdef PAK_WITH_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+#ifdef PAK_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+// Packed asset archive.
+//
+// Layout (little endian):
+//   PakHeader
+//   entry data, each entry aligned to header.alignment
+//   PakEntry table sorted by name hash
+//   name string table
+//
+// The reader maps the whole file, so an uncompressed entry is a pointer into
+// the mapping and costs nothing until its pages are touched.
+
+enum PakCompression : uint32_t {
+    PAK_STORED = 0,
+    PAK_LZ4 = 1,
+    PAK_ZSTD = 2
+};
+
+struct PakHeader {
+    char magic[4];          // "PAK1"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t alignment;
+    uint64_t tocOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+    uint64_t reserved[3];
+};
+
+struct PakEntry {
+    uint64_t hash;          // pakHash of the normalized name
+    uint64_t offset;        // from start of archive
+    uint64_t storedSize;    // bytes in the archive
+    uint64_t size;          // bytes after decompression
+    uint32_t nameOffset;    // into the name table
+    uint32_t nameLength;
+    uint32_t compression;   // PakCompression
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PakHeader) == 64, "PakHeader layout changed");
+static_assert(sizeof(PakEntry) == 48, "PakEntry layout changed");
+
+struct PakSpan {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    explicit operator bool() const { return data != nullptr; }
+};
+
+// "./textures\\wood.png" and "textures/wood.png" name the same entry.
+inline std::string pakNormalizeName(const std::string& name) {
+    std::string n = name;
+    std::replace(n.begin(), n.end(), '\\', '/');
+    while (n.compare(0, 2, "./") == 0) n.erase(0, 2);
+    return n;
+}
+
+inline uint64_t pakHash(const std::string& normalizedName) {
+    return fnv1a(normalizedName.data(), normalizedName.size());
+}
+
+class PakArchive {
+public:
+    static const uint32_t VERSION = 1;
+
+    bool open(const char* path) {
+        entries = nullptr;
+        count = 0;
+        if (!file.open(path, false)) return false;
+
+        const uint8_t* base = file.data();
+        if (file.size() < sizeof(PakHeader)) return fail(path, "TRUNCATED");
+        PakHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, "PAK1", 4) != 0 || header.version != VERSION)
+            return fail(path, "BAD_HEADER");
+
+        uint64_t tocBytes = static_cast<uint64_t>(header.entryCount) * sizeof(PakEntry);
+        // subtract instead of adding offset and size, which a crafted header can wrap
+        uint64_t size = file.size();
+        if (header.tocOffset % alignof(PakEntry) != 0 || header.tocOffset > size || tocBytes > size - header.tocOffset ||
+            header.namesOffset > size || header.namesSize > size - header.namesOffset)
+            return fail(path, "BAD_TABLE");
+
+        entries = reinterpret_cast<const PakEntry*>(base + header.tocOffset);
+        count = header.entryCount;
+        names = reinterpret_cast<const char*>(base + header.namesOffset);
+        namesSize = header.namesSize;
+
+        for (size_t i = 0; i < count; ++i) {
+            const PakEntry& e = entries[i];
+            if (e.offset > file.size() || e.storedSize > file.size() - e.offset ||
+                e.nameOffset + uint64_t(e.nameLength) > namesSize)
+                return fail(path, "BAD_ENTRY");
+            // find() and read() use size for stored entries
+            if (e.compression == PAK_STORED && e.size != e.storedSize) return fail(path, "BAD_ENTRY");
+        }
+        return true;
+    }
+
+    bool isOpen() const { return file.isOpen(); }
+    size_t entryCount() const { return count; }
+    const PakEntry& entryAt(size_t i) const { return entries[i]; }
+    std::string nameOf(const PakEntry& e) const { return std::string(names + e.nameOffset, e.nameLength); }
+
+    const PakEntry* entry(const std::string& name) const {
+        if (!entries) return nullptr;
+        std::string normalized = pakNormalizeName(name);
+        uint64_t h = pakHash(normalized);
+        const PakEntry* end = entries + count;
+        const PakEntry* it = std::lower_bound(entries, end, h,
+            [](const PakEntry& e, uint64_t key) { return e.hash < key; });
+        for (; it != end && it->hash == h; ++it)
+            if (it->nameLength == normalized.size() &&
+                std::memcmp(names + it->nameOffset, normalized.data(), normalized.size()) == 0)
+                return it;
+        return nullptr;
+    }
+
+    bool contains(const std::string& name) const { return entry(name) != nullptr; }
+
+    // Zero-copy view of a stored entry; empty for missing or compressed ones.
+    PakSpan find(const std::string& name) const {
+        PakSpan span;
+        const PakEntry* e = entry(name);
+        if (e && e->compression == PAK_STORED) {
+            span.data = file.data() + e->offset;
+            span.size = static_cast<size_t>(e->size);
+        }
+        return span;
+    }
+
+    // Copies (and decompresses if needed) an entry into out.
+    bool read(const std::string& name, std::vector<uint8_t>& out) const {
+        const PakEntry* e = entry(name);
+        if (!e) return false;
+        const uint8_t* src = file.data() + e->offset;
+        out.resize(static_cast<size_t>(e->size));
+
+        switch (e->compression) {
+        case PAK_STORED:
+            std::memcpy(out.data(), src, out.size());
+            return true;
+#ifdef PAK_WITH_LZ4
+        case PAK_LZ4:
+            return LZ4_decompress_safe(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(out.data()),
+                                       static_cast<int>(e->storedSize), static_cast<int>(e->size)) == static_cast<int>(e->size);
+#endif
+#ifdef PAK_WITH_ZSTD
+        case PAK_ZSTD:
+            return ZSTD_decompress(out.data(), out.size(), src, static_cast<size_t>(e->storedSize)) == e->size;
+#endif
+        default:
+            std::cout << "ERROR::PAK::UNSUPPORTED_COMPRESSION " << name << std::endl;
+            return false;
+        }
+    }
+
+private:
+    MappedFile file;
+    const PakEntry* entries = nullptr;
+    size_t count = 0;
+    const char* names = nullptr;
+    uint64_t namesSize = 0;
+
+    bool fail(const char* path, const char* what) {
+        std::cout << "ERROR::PAK::" << what << " " << path << std::endl;
+        file.close();
+        entries = nullptr;
+        count = 0;
+        return false;
+    }
+};
+
+// Builds an archive in memory and writes it in one go. Used by pak_builder.
+class PakWriter {
+public:
+    explicit PakWriter(uint32_t alignment = 16) : alignment(std::max<uint32_t>(alignment, 8)) {}
+
+    bool addFile(const std::string& name, const std::string& path, PakCompression compression = PAK_STORED) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) {
+            std::cout << "ERROR::PAK::CANNOT_READ " << path << std::endl;
+            return false;
+        }
+        std::vector<uint8_t> data;
+        std::fseek(f, 0, SEEK_END);
+        long size = std::ftell(f);
+        std::fseek(f, 0, SEEK_SET);
+        data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+        size_t got = data.empty() ? 0 : std::fread(data.data(), 1, data.size(), f);
+        std::fclose(f);
+        if (got != data.size()) return false;
+        return addData(name, data, compression);
+    }
+
+    bool addData(const std::string& name, const std::vector<uint8_t>& data, PakCompression compression = PAK_STORED) {
+        Pending p;
+        p.name = pakNormalizeName(name);
+        if (!names.insert(p.name).second) {
+            std::cout << "ERROR::PAK::DUPLICATE_ENTRY " << p.name << std::endl;
+            return false;
+        }
+        p.size = data.size();
+        p.compression = PAK_STORED;
+        if (compression != PAK_STORED && compress(data, compression, p.bytes) && p.bytes.size() < data.size())
+            p.compression = compression;
+        else
+            p.bytes = data; // incompressible or unsupported: store
+        pending.push_back(std::move(p));
+        return true;
+    }
+
+    bool write(const std::string& path) {
+        std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+            uint64_t ha = pakHash(a.name), hb = pakHash(b.name);
+            return ha != hb ? ha < hb : a.name < b.name;
+        });
+
+        std::vector<uint8_t> out(sizeof(PakHeader), 0);
+        std::vector<PakEntry> toc;
+        std::string nameTable;
+
+        for (const Pending& p : pending) {
+            pad(out, alignment);
+            PakEntry e = {};
+            e.hash = pakHash(p.name);
+            e.offset = out.size();
+            e.storedSize = p.bytes.size();
+            e.size = p.size;
+            e.nameOffset = static_cast<uint32_t>(nameTable.size());
+            e.nameLength = static_cast<uint32_t>(p.name.size());
+            e.compression = p.compression;
+            out.insert(out.end(), p.bytes.begin(), p.bytes.end());
+            nameTable += p.name;
+            toc.push_back(e);
+        }
+
+        pad(out, alignof(PakEntry));
+        PakHeader header = {};
+        std::memcpy(header.magic, "PAK1", 4);
+        header.version = PakArchive::VERSION;
+        header.entryCount = static_cast<uint32_t>(toc.size());
+        header.alignment = alignment;
+        header.tocOffset = out.size();
+        const uint8_t* tocBytes = reinterpret_cast<const uint8_t*>(toc.data());
+        out.insert(out.end(), tocBytes, tocBytes + toc.size() * sizeof(PakEntry));
+        header.namesOffset = out.size();
+        header.namesSize = nameTable.size();
+        out.insert(out.end(), nameTable.begin(), nameTable.end());
+        std::memcpy(out.data(), &header, sizeof(header));
+
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) {
+            std::cout << "ERROR::PAK::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+        ok = (std::fclose(f) == 0) && ok;
+        return ok;
+    }
+
+private:
+    struct Pending {
+        std::string name;
+        std::vector<uint8_t> bytes;
+        uint64_t size;
+        PakCompression compression;
+    };
+
+    uint32_t alignment;
+    std::vector<Pending> pending;
+    std::unordered_set<std::string> names;
+
+    static void pad(std::vector<uint8_t>& out, size_t align) {
+        out.resize((out.size() + align - 1) / align * align, 0);
+    }
+
+    static bool compress(const std::vector<uint8_t>& in, PakCompression compression, std::vector<uint8_t>& out) {
+        switch (compression) {
+#ifdef PAK_WITH_LZ4
+        case PAK_LZ4: {
+            out.resize(LZ4_compressBound(static_cast<int>(in.size())));
+            int n = LZ4_compress_HC(reinterpret_cast<const char*>(in.data()), reinterpret_cast<char*>(out.data()),
+                                    static_cast<int>(in.size()), static_cast<int>(out.size()), LZ4HC_CLEVEL_MAX);
+            out.resize(n > 0 ? n : 0);
+            return n > 0;
+        }
+#endif
+#ifdef PAK_WITH_ZSTD
+        case PAK_ZSTD: {
+            out.resize(ZSTD_compressBound(in.size()));
+            size_t n = ZSTD_compress(out.data(), out.size(), in.data(), in.size(), 19);
+            if (ZSTD_isError(n)) return false;
+            out.resize(n);
+            return true;
+        }
+#endif
+        default:
+            (void)in; (void)out;
+            static bool warned = false;
+            if (!warned) std::cout << "WARNING::PAK::COMPRESSION_NOT_BUILT_IN, storing uncompressed" << std::endl;
+            warned = true;
+            return false;
+        }
+    }
+};
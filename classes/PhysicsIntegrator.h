@@ -0,0 +1,78 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+// Raw views of the PhysicsWorld SoA streams, valid until the next
+// create/destroy. Every stream holds at least `padded` aligned floats.
+struct BodyArrays {
+    float *px, *py, *pz;
+    float *qx, *qy, *qz, *qw;
+    float *vx, *vy, *vz;
+    float *wx, *wy, *wz;
+    float *fx, *fy, *fz;      // force accumulators, cleared every step
+    float *tx, *ty, *tz;      // torque accumulators, cleared every step
+    float* invMass;
+    float *iix, *iiy, *iiz;   // inverse principal inertia, body space
+    size_t count;             // live bodies
+    size_t padded;            // count rounded up to PHYSICS_LANES
+};
+
+struct IntegrationParams {
+    float dt = 0.0f;
+    float gravityX = 0.0f, gravityY = 0.0f, gravityZ = 0.0f;
+    float linearScale = 1.0f;   // 1 / (1 + dt * damping)
+    float angularScale = 1.0f;
+};
+
+// Semi-implicit Euler over every body: velocities from gravity, forces and
+// torques first, then positions and orientations from the new velocities,
+// then the accumulators are cleared. Kinematic bodies (zero inverse mass)
+// skip gravity and damping but still move. Integration touches every body
+// every step and does little arithmetic per byte, so the wide kernels in
+// SimdKernels.inl stream each array once with aligned loads and stores.
+//
+// Scalar reference: the wide kernels must match it to rounding (they use
+// FMA, so results differ in the last bits, not in behaviour).
+inline void integrateBodiesScalar(const BodyArrays& b, const IntegrationParams& p) {
+    const float dt = p.dt, halfDt = 0.5f * p.dt;
+    for (size_t i = 0; i < b.count; ++i) {
+        float x = b.qx[i], y = b.qy[i], z = b.qz[i], w = b.qw[i];
+        float im = b.invMass[i];
+        if (im > 0.0f) {
+            b.vx[i] = (b.vx[i] + (p.gravityX + b.fx[i] * im) * dt) * p.linearScale;
+            b.vy[i] = (b.vy[i] + (p.gravityY + b.fy[i] * im) * dt) * p.linearScale;
+            b.vz[i] = (b.vz[i] + (p.gravityZ + b.fz[i] * im) * dt) * p.linearScale;
+
+            // world inverse inertia R * diag(ii) * R^T applied to the torque:
+            // rotate into body space, scale, rotate back
+            float tx = b.tx[i], ty = b.ty[i], tz = b.tz[i];
+            float cx = 2.0f * (z * ty - y * tz), cy = 2.0f * (x * tz - z * tx), cz = 2.0f * (y * tx - x * ty);
+            float lx = (tx + w * cx - (y * cz - z * cy)) * b.iix[i];
+            float ly = (ty + w * cy - (z * cx - x * cz)) * b.iiy[i];
+            float lz = (tz + w * cz - (x * cy - y * cx)) * b.iiz[i];
+            cx = 2.0f * (y * lz - z * ly); cy = 2.0f * (z * lx - x * lz); cz = 2.0f * (x * ly - y * lx);
+            float ax = lx + w * cx + (y * cz - z * cy);
+            float ay = ly + w * cy + (z * cx - x * cz);
+            float az = lz + w * cz + (x * cy - y * cx);
+            b.wx[i] = (b.wx[i] + ax * dt) * p.angularScale;
+            b.wy[i] = (b.wy[i] + ay * dt) * p.angularScale;
+            b.wz[i] = (b.wz[i] + az * dt) * p.angularScale;
+        }
+
+        b.px[i] += b.vx[i] * dt;
+        b.py[i] += b.vy[i] * dt;
+        b.pz[i] += b.vz[i] * dt;
+
+        // q += 0.5 * dt * (w, 0) * q, then renormalise
+        float hx = halfDt * b.wx[i], hy = halfDt * b.wy[i], hz = halfDt * b.wz[i];
+        float nx = x + hx * w + hy * z - hz * y;
+        float ny = y + hy * w + hz * x - hx * z;
+        float nz = z + hz * w + hx * y - hy * x;
+        float nw = w - hx * x - hy * y - hz * z;
+        float inv = 1.0f / std::sqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+        b.qx[i] = nx * inv; b.qy[i] = ny * inv; b.qz[i] = nz * inv; b.qw[i] = nw * inv;
+
+        b.fx[i] = b.fy[i] = b.fz[i] = 0.0f;
+        b.tx[i] = b.ty[i] = b.tz[i] = 0.0f;
+    }
+}
@@ -0,0 +1,365 @@
+#pragma once
+#include "AlignedArray.h"
+#include "BoxCollision.h"
+#include "Broadphase.h"
+#include "SimdKernels.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Rigid bodies stored as structure-of-arrays: every component (px, py, ...)
+// is its own 64-byte aligned float array, so an integrator streams each
+// stream linearly and a SIMD kernel loads 4/8/16 bodies of one component
+// with a single aligned load. Arrays are padded to a multiple of
+// PHYSICS_LANES with inert bodies (zero velocity, identity orientation,
+// zero inverse mass) so kernels never need a scalar tail.
+//
+// Bodies are referenced through handles. A handle names a slot; the slot
+// maps to the body's current dense index, which changes when another body
+// is destroyed and the last one is swapped into the hole. The generation
+// counter makes stale handles detectable.
+//
+// The pose before the latest step is kept alongside the current one so the
+// renderer can interpolate between the two (or extrapolate past the current
+// one) when it runs at a different rate from the fixed simulation step.
+static const uint32_t PHYSICS_LANES = 16;
+
+enum RenderTransformMode {
+    RENDER_INTERPOLATE,  // between the last two steps: exact, one step behind
+    RENDER_EXTRAPOLATE,  // past the last step along the velocities: no lag, may overshoot
+};
+
+struct BodyHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+struct BodyDesc {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 linearVelocity = glm::vec3(0.0f);
+    glm::vec3 angularVelocity = glm::vec3(0.0f); // world space, rad/s
+    float mass = 1.0f;                            // 0 = kinematic: moves by its velocity, ignores forces
+    glm::vec3 inertia = glm::vec3(1.0f / 6.0f);   // principal moments in body space (unit cube, mass 1)
+    glm::vec3 halfExtents = glm::vec3(0.5f);      // body-space box around the shape, for world bounds
+};
+
+// Principal moments of a solid box.
+inline glm::vec3 boxInertia(float mass, const glm::vec3& halfExtents) {
+    glm::vec3 e2 = halfExtents * halfExtents * 4.0f;
+    return glm::vec3(e2.y + e2.z, e2.x + e2.z, e2.x + e2.y) * (mass / 12.0f);
+}
+
+class PhysicsWorld {
+public:
+    glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+    float linearDamping = 0.0f;  // per second
+    float angularDamping = 0.0f;
+
+    BodyHandle createBody(const BodyDesc& desc) {
+        size_t index = count++;
+        if (count > capacity) grow(count);
+        padded = (count + PHYSICS_LANES - 1) / PHYSICS_LANES * PHYSICS_LANES;
+
+        px[index] = desc.position.x; py[index] = desc.position.y; pz[index] = desc.position.z;
+        glm::quat q = desc.orientation;
+        float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        float inv = len > 0.0f ? 1.0f / len : 0.0f;
+        qx[index] = q.x * inv; qy[index] = q.y * inv; qz[index] = q.z * inv; qw[index] = len > 0.0f ? q.w * inv : 1.0f;
+        vx[index] = desc.linearVelocity.x; vy[index] = desc.linearVelocity.y; vz[index] = desc.linearVelocity.z;
+        wx[index] = desc.angularVelocity.x; wy[index] = desc.angularVelocity.y; wz[index] = desc.angularVelocity.z;
+        fx[index] = fy[index] = fz[index] = 0.0f;
+        tx[index] = ty[index] = tz[index] = 0.0f;
+        bool dynamic = desc.mass > 0.0f;
+        invMass[index] = dynamic ? 1.0f / desc.mass : 0.0f;
+        iix[index] = dynamic && desc.inertia.x > 0.0f ? 1.0f / desc.inertia.x : 0.0f;
+        iiy[index] = dynamic && desc.inertia.y > 0.0f ? 1.0f / desc.inertia.y : 0.0f;
+        iiz[index] = dynamic && desc.inertia.z > 0.0f ? 1.0f / desc.inertia.z : 0.0f;
+        hx[index] = desc.halfExtents.x; hy[index] = desc.halfExtents.y; hz[index] = desc.halfExtents.z;
+        storePrevious(index);
+        boundsDirty = true;
+
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = uint32_t(slots.size());
+            slots.push_back(Slot());
+        }
+        slots[slot].dense = uint32_t(index);
+        if (denseToSlot.size() < count) denseToSlot.resize(count);
+        denseToSlot[index] = slot;
+        if (proxyIds.size() < count) proxyIds.resize(count);
+        proxyIds[index] = NO_PROXY; // added by the next syncBroadphase()
+
+        BodyHandle handle;
+        handle.slot = slot;
+        handle.generation = slots[slot].generation;
+        return handle;
+    }
+
+    // Swaps the last body into the freed dense index; other handles stay valid.
+    void destroyBody(BodyHandle handle) {
+        if (!isValid(handle)) return;
+        Slot& slot = slots[handle.slot];
+        size_t index = slot.dense;
+        size_t last = count - 1;
+        if (broadphase && proxyIds[index] != NO_PROXY) broadphase->removeProxy(proxyIds[index]);
+        if (index != last) {
+            for (AlignedArray<float>* stream : streams()) (*stream)[index] = (*stream)[last];
+            uint32_t movedSlot = denseToSlot[last];
+            slots[movedSlot].dense = uint32_t(index);
+            denseToSlot[index] = movedSlot;
+            proxyIds[index] = proxyIds[last];
+        }
+        resetLane(last);
+        --count;
+        padded = (count + PHYSICS_LANES - 1) / PHYSICS_LANES * PHYSICS_LANES;
+
+        slot.dense = UINT32_MAX;
+        ++slot.generation;
+        freeSlots.push_back(handle.slot);
+    }
+
+    bool isValid(BodyHandle handle) const {
+        return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation &&
+               slots[handle.slot].dense != UINT32_MAX;
+    }
+
+    size_t size() const { return count; }
+
+    // Dense index of a body, for indexing the arrays() streams directly.
+    size_t indexOf(BodyHandle handle) const { return slots[handle.slot].dense; }
+    // Broadphase pairs name bodies by handle slot.
+    size_t indexOfSlot(uint32_t slot) const { return slots[slot].dense; }
+
+    glm::vec3 position(BodyHandle h) const { size_t i = indexOf(h); return glm::vec3(px[i], py[i], pz[i]); }
+    glm::quat orientation(BodyHandle h) const { size_t i = indexOf(h); return glm::quat(qw[i], qx[i], qy[i], qz[i]); }
+    glm::vec3 linearVelocity(BodyHandle h) const { size_t i = indexOf(h); return glm::vec3(vx[i], vy[i], vz[i]); }
+    glm::vec3 angularVelocity(BodyHandle h) const { size_t i = indexOf(h); return glm::vec3(wx[i], wy[i], wz[i]); }
+
+    // Teleports: the previous pose moves too, so nothing is interpolated across the jump.
+    void setPosition(BodyHandle h, const glm::vec3& p) {
+        size_t i = indexOf(h);
+        px[i] = p.x; py[i] = p.y; pz[i] = p.z;
+        storePrevious(i);
+        boundsDirty = true;
+    }
+    void setOrientation(BodyHandle h, const glm::quat& q) {
+        size_t i = indexOf(h);
+        qx[i] = q.x; qy[i] = q.y; qz[i] = q.z; qw[i] = q.w;
+        storePrevious(i);
+        boundsDirty = true;
+    }
+    void setLinearVelocity(BodyHandle h, const glm::vec3& v) { size_t i = indexOf(h); vx[i] = v.x; vy[i] = v.y; vz[i] = v.z; }
+    void setAngularVelocity(BodyHandle h, const glm::vec3& w) { size_t i = indexOf(h); wx[i] = w.x; wy[i] = w.y; wz[i] = w.z; }
+
+    void applyForce(BodyHandle h, const glm::vec3& f) { size_t i = indexOf(h); fx[i] += f.x; fy[i] += f.y; fz[i] += f.z; }
+    void applyTorque(BodyHandle h, const glm::vec3& t) { size_t i = indexOf(h); tx[i] += t.x; ty[i] += t.y; tz[i] += t.z; }
+
+    // Model matrix (rotation then translation) of a body.
+    glm::mat4 transform(BodyHandle h) const { return transformAt(indexOf(h)); }
+
+    glm::mat4 transformAt(size_t i) const {
+        return poseMatrix(qx[i], qy[i], qz[i], qw[i], px[i], py[i], pz[i]);
+    }
+
+    // Pose for rendering at alpha steps past the latest step (0..1 from
+    // FixedTimestep::alpha()). Extrapolation continues the last step's
+    // motion: under semi-implicit Euler, current - previous is exactly the
+    // last step's velocity times dt.
+    glm::mat4 renderTransform(BodyHandle h, float alpha, RenderTransformMode mode = RENDER_INTERPOLATE) const {
+        size_t i = indexOf(h);
+        float t = mode == RENDER_INTERPOLATE ? alpha : 1.0f + alpha;
+        // nlerp along the shorter arc; steps are small so it tracks slerp closely
+        float sign = (prevQx[i] * qx[i] + prevQy[i] * qy[i] + prevQz[i] * qz[i] + prevQw[i] * qw[i]) < 0.0f ? -1.0f : 1.0f;
+        float a = 1.0f - t, b = t * sign;
+        float x = prevQx[i] * a + qx[i] * b, y = prevQy[i] * a + qy[i] * b;
+        float z = prevQz[i] * a + qz[i] * b, w = prevQw[i] * a + qw[i] * b;
+        float inv = 1.0f / std::sqrt(x * x + y * y + z * z + w * w);
+        return poseMatrix(x * inv, y * inv, z * inv, w * inv, prevPx[i] + (px[i] - prevPx[i]) * t,
+                          prevPy[i] + (py[i] - prevPy[i]) * t, prevPz[i] + (pz[i] - prevPz[i]) * t);
+    }
+
+    // renderTransform for every body at once, indexed by indexOf().
+    void renderTransforms(float alpha, RenderTransformMode mode, std::vector<glm::mat4>& out) const {
+        out.resize(count);
+        if (!count) return;
+        float t = mode == RENDER_INTERPOLATE ? alpha : 1.0f + alpha;
+        PoseStreams previous = { prevPx.data(), prevPy.data(), prevPz.data(),
+                                 prevQx.data(), prevQy.data(), prevQz.data(), prevQw.data() };
+        blendPoseMatrices(previous, pose(), t, count, &out[0][0][0]);
+    }
+
+    // A body's halfExtents box at its current pose.
+    OrientedBox box(BodyHandle h) const { return boxAt(indexOf(h)); }
+
+    OrientedBox boxAt(size_t i) const {
+        return orientedBox(glm::vec3(px[i], py[i], pz[i]), glm::quat(qw[i], qx[i], qy[i], qz[i]),
+                           glm::vec3(hx[i], hy[i], hz[i]));
+    }
+
+    // Box-box narrowphase over the current broadphase pairs; one manifold
+    // per touching pair, a and b set to the bodies' handle slots.
+    void collideBoxes(std::vector<ContactManifold>& out) const {
+        out.clear();
+        if (!broadphase) return;
+        ContactManifold m;
+        for (const OverlapPair& pair : broadphase->pairs()) {
+            if (!collideBoxBox(boxAt(indexOfSlot(pair.a)), boxAt(indexOfSlot(pair.b)), m)) continue;
+            m.a = pair.a;
+            m.b = pair.b;
+            out.push_back(m);
+        }
+    }
+
+    // World AABBs of every body's halfExtents box at the current pose,
+    // recomputed on demand after a step or an edit. Padded streams.
+    BoundsStreams bounds() {
+        BoundsStreams b = { minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data() };
+        if (boundsDirty && count) updateBodyBounds(pose(), hx.data(), hy.data(), hz.data(), b, padded);
+        boundsDirty = false;
+        return b;
+    }
+
+    BodyArrays arrays() {
+        BodyArrays a;
+        a.px = px.data(); a.py = py.data(); a.pz = pz.data();
+        a.qx = qx.data(); a.qy = qy.data(); a.qz = qz.data(); a.qw = qw.data();
+        a.vx = vx.data(); a.vy = vy.data(); a.vz = vz.data();
+        a.wx = wx.data(); a.wy = wy.data(); a.wz = wz.data();
+        a.fx = fx.data(); a.fy = fy.data(); a.fz = fz.data();
+        a.tx = tx.data(); a.ty = ty.data(); a.tz = tz.data();
+        a.invMass = invMass.data();
+        a.iix = iix.data(); a.iiy = iiy.data(); a.iiz = iiz.data();
+        a.count = count;
+        a.padded = padded;
+        return a;
+    }
+
+    // One fixed step of the integrator (see PhysicsIntegrator.h).
+    void step(float dt) {
+        boundsDirty = true;
+        std::memcpy(prevPx.data(), px.data(), count * sizeof(float));
+        std::memcpy(prevPy.data(), py.data(), count * sizeof(float));
+        std::memcpy(prevPz.data(), pz.data(), count * sizeof(float));
+        std::memcpy(prevQx.data(), qx.data(), count * sizeof(float));
+        std::memcpy(prevQy.data(), qy.data(), count * sizeof(float));
+        std::memcpy(prevQz.data(), qz.data(), count * sizeof(float));
+        std::memcpy(prevQw.data(), qw.data(), count * sizeof(float));
+
+        IntegrationParams params;
+        params.dt = dt;
+        params.gravityX = gravity.x;
+        params.gravityY = gravity.y;
+        params.gravityZ = gravity.z;
+        params.linearScale = 1.0f / (1.0f + dt * linearDamping);
+        params.angularScale = 1.0f / (1.0f + dt * angularDamping);
+        if (count) integrateBodies(arrays(), params);
+        if (broadphase) syncBroadphase();
+    }
+
+    // Bodies get a proxy in the broadphase, keyed by handle slot, and the
+    // pairs are refreshed after every step. Pass null to detach.
+    void setBroadphase(Broadphase* newBroadphase) {
+        if (broadphase)
+            for (size_t i = 0; i < count; ++i)
+                if (proxyIds[i] != NO_PROXY) broadphase->removeProxy(proxyIds[i]);
+        std::fill(proxyIds.begin(), proxyIds.end(), NO_PROXY);
+        broadphase = newBroadphase;
+        if (broadphase) syncBroadphase();
+    }
+
+    // Pushes the current bounds of every body into the broadphase.
+    void syncBroadphase() {
+        broadphase->pairCache().clearEvents();
+        BoundsStreams b = bounds();
+        for (size_t i = 0; i < count; ++i) {
+            Aabb box;
+            box.min = glm::vec3(b.minX[i], b.minY[i], b.minZ[i]);
+            box.max = glm::vec3(b.maxX[i], b.maxY[i], b.maxZ[i]);
+            if (proxyIds[i] == NO_PROXY) proxyIds[i] = broadphase->addProxy(box, denseToSlot[i]);
+            else broadphase->moveProxy(proxyIds[i], box);
+        }
+        broadphase->updatePairs();
+    }
+
+private:
+    struct Slot {
+        uint32_t dense = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+
+    AlignedArray<float> px, py, pz;
+    AlignedArray<float> qx, qy, qz, qw;
+    AlignedArray<float> vx, vy, vz;
+    AlignedArray<float> wx, wy, wz;
+    AlignedArray<float> fx, fy, fz;
+    AlignedArray<float> tx, ty, tz;
+    AlignedArray<float> invMass;
+    AlignedArray<float> iix, iiy, iiz;
+    AlignedArray<float> prevPx, prevPy, prevPz;
+    AlignedArray<float> prevQx, prevQy, prevQz, prevQw;
+    AlignedArray<float> hx, hy, hz;
+    AlignedArray<float> minX, minY, minZ, maxX, maxY, maxZ;
+    static const uint32_t NO_PROXY = UINT32_MAX;
+
+    std::vector<uint32_t> denseToSlot;
+    std::vector<uint32_t> proxyIds; // broadphase proxy per dense index
+    Broadphase* broadphase = nullptr;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    size_t count = 0;
+    size_t padded = 0;
+    size_t capacity = 0;
+    bool boundsDirty = true;
+
+    std::array<AlignedArray<float>*, 39> streams() {
+        return { &px, &py, &pz, &qx, &qy, &qz, &qw, &vx, &vy, &vz, &wx, &wy, &wz,
+                 &fx, &fy, &fz, &tx, &ty, &tz, &invMass, &iix, &iiy, &iiz,
+                 &prevPx, &prevPy, &prevPz, &prevQx, &prevQy, &prevQz, &prevQw,
+                 &hx, &hy, &hz, &minX, &minY, &minZ, &maxX, &maxY, &maxZ };
+    }
+
+    void grow(size_t needed) {
+        size_t grown = capacity ? capacity * 2 : 1024;
+        while (grown < needed) grown *= 2;
+        grown = (grown + PHYSICS_LANES - 1) / PHYSICS_LANES * PHYSICS_LANES;
+        for (AlignedArray<float>* stream : streams()) stream->resize(grown);
+        for (size_t i = capacity; i < grown; ++i) resetLane(i);
+        capacity = grown;
+    }
+
+    // Inert padding body: identity orientation keeps renormalisation finite.
+    void resetLane(size_t i) {
+        for (AlignedArray<float>* stream : streams()) (*stream)[i] = 0.0f;
+        qw[i] = 1.0f;
+        prevQw[i] = 1.0f;
+    }
+
+    PoseStreams pose() const {
+        PoseStreams p = { px.data(), py.data(), pz.data(), qx.data(), qy.data(), qz.data(), qw.data() };
+        return p;
+    }
+
+    void storePrevious(size_t i) {
+        prevPx[i] = px[i]; prevPy[i] = py[i]; prevPz[i] = pz[i];
+        prevQx[i] = qx[i]; prevQy[i] = qy[i]; prevQz[i] = qz[i]; prevQw[i] = qw[i];
+    }
+
+    static glm::mat4 poseMatrix(float x, float y, float z, float w, float ox, float oy, float oz) {
+        glm::mat4 m(1.0f);
+        m[0][0] = 1.0f - 2.0f * (y * y + z * z); m[0][1] = 2.0f * (x * y + w * z);        m[0][2] = 2.0f * (x * z - w * y);
+        m[1][0] = 2.0f * (x * y - w * z);        m[1][1] = 1.0f - 2.0f * (x * x + z * z); m[1][2] = 2.0f * (y * z + w * x);
+        m[2][0] = 2.0f * (x * z + w * y);        m[2][1] = 2.0f * (y * z - w * x);        m[2][2] = 1.0f - 2.0f * (x * x + y * y);
+        m[3][0] = ox; m[3][1] = oy; m[3][2] = oz;
+        return m;
+    }
+};
@@ -0,0 +1,462 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+typedef int RenderResource;
+static const RenderResource RENDER_NO_RESOURCE = -1;
+static const RenderResource RENDER_BACKBUFFER = 0; // the default framebuffer, always present
+
+struct RenderTextureDesc {
+    int width = 0;
+    int height = 0;
+    GLenum internalFormat = GL_RGBA8;
+
+    bool operator==(const RenderTextureDesc& o) const {
+        return width == o.width && height == o.height && internalFormat == o.internalFormat;
+    }
+};
+
+class RenderGraph;
+
+// Declares what one pass reads and writes. Colour attachments are bound in
+// the order write() is called. Imported textures other than the backbuffer
+// are not attached; a pass writing one binds its own framebuffer.
+class RenderPassBuilder {
+public:
+    RenderResource create(const std::string& name, const RenderTextureDesc& desc);
+    void read(RenderResource resource);
+    void write(RenderResource resource);
+    void writeDepth(RenderResource resource);
+    void writeBackbuffer() { write(RENDER_BACKBUFFER); }
+    // Keeps the pass even if nothing reads its outputs (queries, readbacks).
+    void sideEffect();
+    void execute(std::function<void(RenderGraph&)> fn);
+
+private:
+    friend class RenderGraph;
+    RenderPassBuilder(RenderGraph* graph, int pass) : graph(graph), pass(pass) {}
+    RenderGraph* graph;
+    int pass;
+};
+
+// Frame graph rebuilt every frame: passes declare their attachments, then
+// compile() drops passes whose results are never consumed, orders the rest
+// by their dependencies (declaration order breaks ties) and maps transient
+// textures onto a persistent pool. Two transient resources with the same
+// description whose lifetimes do not overlap share one GL texture, so extra
+// shadow, post and debug passes reuse targets instead of adding memory.
+// Imported resources (the backbuffer, shadow maps) are owned elsewhere and
+// count as consumed, so passes writing them always run.
+class RenderGraph {
+public:
+    struct Stats {
+        int declaredPasses = 0;
+        int culledPasses = 0;
+        int transientResources = 0;
+        int physicalTextures = 0;
+        size_t declaredBytes = 0; // what separate textures would cost
+        size_t allocatedBytes = 0;
+    };
+
+    // Starts a new frame; the pool and cached framebuffers carry over.
+    // The backbuffer is the window unless another framebuffer is given
+    // (e.g. a scaled offscreen target).
+    void reset(int backbufferWidth, int backbufferHeight, unsigned int backbufferFramebuffer = 0) {
+        backbufferFbo = backbufferFramebuffer;
+        passes.clear();
+        resources.clear();
+        order.clear();
+        Resource backbuffer;
+        backbuffer.name = "backbuffer";
+        backbuffer.imported = true;
+        backbuffer.desc.width = backbufferWidth;
+        backbuffer.desc.height = backbufferHeight;
+        resources.push_back(backbuffer);
+    }
+
+    RenderPassBuilder addPass(const std::string& name) {
+        Pass p;
+        p.name = name;
+        passes.push_back(p);
+        return RenderPassBuilder(this, static_cast<int>(passes.size() - 1));
+    }
+
+    // Transient texture that may be written and read by later passes.
+    RenderResource createTexture(const std::string& name, const RenderTextureDesc& desc) {
+        Resource r;
+        r.name = name;
+        r.desc = desc;
+        resources.push_back(r);
+        return static_cast<RenderResource>(resources.size() - 1);
+    }
+
+    // Externally owned texture (e.g. a shadow map array kept across frames).
+    RenderResource importTexture(const std::string& name, unsigned int texture, const RenderTextureDesc& desc) {
+        RenderResource id = createTexture(name, desc);
+        resources[id].imported = true;
+        resources[id].texture = texture;
+        return id;
+    }
+
+    void compile() {
+        cull();
+        schedule();
+        allocate();
+    }
+
+    void execute() {
+        for (int p : order) {
+            const Pass& pass = passes[p];
+            bindTargets(pass);
+            if (pass.execute) pass.execute(*this);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, backbufferFbo);
+        releaseUnused();
+    }
+
+    // GL texture behind a resource; valid inside execute callbacks.
+    unsigned int texture(RenderResource resource) const {
+        const Resource& r = resources[resource];
+        return r.imported ? r.texture : pool[r.physical].texture;
+    }
+
+    const RenderTextureDesc& desc(RenderResource resource) const { return resources[resource].desc; }
+
+    // Copies depth (or colour) from a transient target to the backbuffer,
+    // e.g. so forward overlays can depth-test against a deferred scene.
+    void blitToBackbuffer(RenderResource source, GLbitfield mask) {
+        const Resource& r = resources[source];
+        bool depth = isDepthFormat(r.desc.internalFormat);
+        std::vector<unsigned int> colour;
+        if (!depth) colour.push_back(texture(source));
+        unsigned int fbo = framebufferFor(colour, depth ? texture(source) : 0, r.desc.internalFormat);
+        const Resource& back = resources[RENDER_BACKBUFFER];
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, backbufferFbo);
+        glBlitFramebuffer(0, 0, r.desc.width, r.desc.height, 0, 0, back.desc.width, back.desc.height, mask, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, currentFramebuffer);
+    }
+
+    const Stats& stats() const { return frameStats; }
+
+    // Deletes pooled textures and framebuffers; call while the context is alive.
+    void cleanUp() {
+        for (auto& f : framebuffers) glDeleteFramebuffers(1, &f.second);
+        for (auto& t : pool) glDeleteTextures(1, &t.texture);
+        framebuffers.clear();
+        pool.clear();
+    }
+
+private:
+    friend class RenderPassBuilder;
+
+    struct Resource {
+        std::string name;
+        RenderTextureDesc desc;
+        bool imported = false;
+        unsigned int texture = 0;  // imported only
+        int physical = -1;         // pool slot for transient resources
+        int readers = 0;
+        int firstUse = -1, lastUse = -1; // positions in the execution order
+        std::vector<int> writers;
+    };
+
+    struct Pass {
+        std::string name;
+        std::vector<RenderResource> reads;
+        std::vector<RenderResource> colourWrites;
+        RenderResource depthWrite = RENDER_NO_RESOURCE;
+        bool sideEffect = false;
+        bool culled = false;
+        int refCount = 0;
+        std::function<void(RenderGraph&)> execute;
+    };
+
+    struct PooledTexture {
+        RenderTextureDesc desc;
+        unsigned int texture = 0;
+        int busyUntil = -1;   // last pass position using it this frame
+        int unusedFrames = 0;
+        bool usedThisFrame = false;
+    };
+
+    std::vector<Pass> passes;
+    std::vector<Resource> resources;
+    std::vector<int> order;
+    std::vector<PooledTexture> pool;
+    std::map<std::vector<unsigned int>, unsigned int> framebuffers;
+    unsigned int currentFramebuffer = 0;
+    unsigned int backbufferFbo = 0;
+    Stats frameStats;
+
+    static bool isDepthFormat(GLenum f) {
+        return f == GL_DEPTH_COMPONENT16 || f == GL_DEPTH_COMPONENT24 || f == GL_DEPTH_COMPONENT32F ||
+               f == GL_DEPTH24_STENCIL8 || f == GL_DEPTH32F_STENCIL8;
+    }
+
+    static size_t bytesPerPixel(GLenum f) {
+        switch (f) {
+        case GL_R8: return 1;
+        case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: return 2;
+        case GL_RGBA16F: case GL_RG32F: return 8;
+        case GL_RGBA32F: return 16;
+        case GL_DEPTH32F_STENCIL8: return 8;
+        default: return 4; // RGBA8, R32F, RG16F, R11G11B10F, DEPTH24(+S8)
+        }
+    }
+
+    void cull() {
+        for (Pass& p : passes) {
+            p.culled = false;
+            p.refCount = static_cast<int>(p.colourWrites.size()) + (p.depthWrite != RENDER_NO_RESOURCE ? 1 : 0);
+            if (p.sideEffect) p.refCount += 1;
+        }
+        std::vector<RenderResource> unused;
+        for (Pass& p : passes) {
+            if (p.refCount > 0) continue;
+            p.culled = true; // writes nothing at all
+            for (RenderResource in : p.reads) resources[in].readers -= 1;
+        }
+        for (size_t i = 0; i < resources.size(); ++i) {
+            Resource& r = resources[i];
+            if (r.imported) r.readers += 1; // consumed outside the graph
+            if (r.readers == 0) unused.push_back(static_cast<RenderResource>(i));
+        }
+        while (!unused.empty()) {
+            RenderResource id = unused.back();
+            unused.pop_back();
+            for (int w : resources[id].writers) {
+                Pass& p = passes[w];
+                if (p.culled || --p.refCount > 0) continue;
+                p.culled = true;
+                for (RenderResource in : p.reads)
+                    if (--resources[in].readers == 0) unused.push_back(in);
+            }
+        }
+    }
+
+    // Kahn's algorithm over read-after-write, write-after-write and
+    // write-after-read edges; the lowest declaration index goes first.
+    void schedule() {
+        size_t n = passes.size();
+        std::vector<std::vector<int>> edges(n);
+        std::vector<int> incoming(n, 0);
+        std::vector<int> lastWriter(resources.size(), -1);
+        std::vector<std::vector<int>> readersSinceWrite(resources.size());
+        auto addEdge = [&](int from, int to) {
+            if (from < 0 || from == to) return;
+            edges[from].push_back(to);
+            ++incoming[to];
+        };
+        for (size_t i = 0; i < n; ++i) {
+            const Pass& p = passes[i];
+            if (p.culled) continue;
+            int pi = static_cast<int>(i);
+            for (RenderResource r : p.reads) {
+                addEdge(lastWriter[r], pi);
+                readersSinceWrite[r].push_back(pi);
+            }
+            auto written = [&](RenderResource r) {
+                addEdge(lastWriter[r], pi);
+                for (int reader : readersSinceWrite[r]) addEdge(reader, pi);
+                readersSinceWrite[r].clear();
+                lastWriter[r] = pi;
+            };
+            for (RenderResource r : p.colourWrites) written(r);
+            if (p.depthWrite != RENDER_NO_RESOURCE) written(p.depthWrite);
+        }
+
+        std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+        for (size_t i = 0; i < n; ++i)
+            if (!passes[i].culled && incoming[i] == 0) ready.push(static_cast<int>(i));
+        order.clear();
+        while (!ready.empty()) {
+            int p = ready.top();
+            ready.pop();
+            order.push_back(p);
+            for (int next : edges[p])
+                if (--incoming[next] == 0) ready.push(next);
+        }
+    }
+
+    void allocate() {
+        for (Resource& r : resources) { r.firstUse = r.lastUse = -1; r.physical = -1; }
+        for (size_t pos = 0; pos < order.size(); ++pos) {
+            const Pass& p = passes[order[pos]];
+            auto touch = [&](RenderResource id) {
+                Resource& r = resources[id];
+                if (r.firstUse < 0) r.firstUse = static_cast<int>(pos);
+                r.lastUse = static_cast<int>(pos);
+            };
+            for (RenderResource r : p.reads) touch(r);
+            for (RenderResource r : p.colourWrites) touch(r);
+            if (p.depthWrite != RENDER_NO_RESOURCE) touch(p.depthWrite);
+        }
+
+        for (PooledTexture& t : pool) { t.busyUntil = -1; t.usedThisFrame = false; }
+        frameStats = Stats();
+        frameStats.declaredPasses = static_cast<int>(passes.size());
+        frameStats.culledPasses = static_cast<int>(passes.size() - order.size());
+
+        // hand out pool slots in order of first use; a slot is free once
+        // its previous occupant's last pass has run
+        std::vector<RenderResource> transient;
+        for (size_t i = 0; i < resources.size(); ++i)
+            if (!resources[i].imported && resources[i].firstUse >= 0) transient.push_back(static_cast<RenderResource>(i));
+        std::sort(transient.begin(), transient.end(), [this](RenderResource a, RenderResource b) {
+            return resources[a].firstUse < resources[b].firstUse;
+        });
+        for (RenderResource id : transient) {
+            Resource& r = resources[id];
+            int slot = -1;
+            for (size_t s = 0; s < pool.size(); ++s) {
+                if (pool[s].desc == r.desc && pool[s].busyUntil < r.firstUse) { slot = static_cast<int>(s); break; }
+            }
+            if (slot < 0) slot = createPooled(r.desc);
+            pool[slot].busyUntil = r.lastUse;
+            pool[slot].usedThisFrame = true;
+            r.physical = slot;
+            ++frameStats.transientResources;
+            frameStats.declaredBytes += size_t(r.desc.width) * r.desc.height * bytesPerPixel(r.desc.internalFormat);
+        }
+        for (const PooledTexture& t : pool) {
+            if (!t.usedThisFrame) continue;
+            ++frameStats.physicalTextures;
+            frameStats.allocatedBytes += size_t(t.desc.width) * t.desc.height * bytesPerPixel(t.desc.internalFormat);
+        }
+    }
+
+    int createPooled(const RenderTextureDesc& desc) {
+        PooledTexture t;
+        t.desc = desc;
+        glGenTextures(1, &t.texture);
+        glBindTexture(GL_TEXTURE_2D, t.texture);
+        bool depth = isDepthFormat(desc.internalFormat);
+        GLenum format = depth ? (desc.internalFormat == GL_DEPTH24_STENCIL8 || desc.internalFormat == GL_DEPTH32F_STENCIL8
+                                     ? GL_DEPTH_STENCIL : GL_DEPTH_COMPONENT)
+                              : GL_RGBA;
+        GLenum type = desc.internalFormat == GL_DEPTH24_STENCIL8 ? GL_UNSIGNED_INT_24_8
+                    : desc.internalFormat == GL_DEPTH32F_STENCIL8 ? GL_FLOAT_32_UNSIGNED_INT_24_8_REV
+                    : GL_FLOAT;
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.internalFormat, desc.width, desc.height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        pool.push_back(t);
+        return static_cast<int>(pool.size() - 1);
+    }
+
+    unsigned int framebufferFor(const std::vector<unsigned int>& colour, unsigned int depth, GLenum depthFormat) {
+        std::vector<unsigned int> key = colour;
+        key.push_back(depth);
+        auto it = framebuffers.find(key);
+        if (it != framebuffers.end()) return it->second;
+
+        unsigned int fbo = 0;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        std::vector<GLenum> drawBuffers;
+        for (size_t i = 0; i < colour.size(); ++i) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + GLenum(i), GL_TEXTURE_2D, colour[i], 0);
+            drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + GLenum(i));
+        }
+        if (depth) {
+            bool stencil = depthFormat == GL_DEPTH24_STENCIL8 || depthFormat == GL_DEPTH32F_STENCIL8;
+            glFramebufferTexture2D(GL_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                                   GL_TEXTURE_2D, depth, 0);
+        }
+        if (drawBuffers.empty()) {
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        } else {
+            glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+        }
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::RENDER_GRAPH::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        framebuffers[key] = fbo;
+        return fbo;
+    }
+
+    void bindTargets(const Pass& pass) {
+        auto external = [this](RenderResource r) { return r > RENDER_BACKBUFFER && resources[r].imported; };
+        if (std::any_of(pass.colourWrites.begin(), pass.colourWrites.end(), external) ||
+            (pass.depthWrite != RENDER_NO_RESOURCE && external(pass.depthWrite))) {
+            glBindFramebuffer(GL_FRAMEBUFFER, backbufferFbo);
+            currentFramebuffer = backbufferFbo;
+            return;
+        }
+        bool backbuffer = std::find(pass.colourWrites.begin(), pass.colourWrites.end(), RENDER_BACKBUFFER) != pass.colourWrites.end()
+                       || pass.depthWrite == RENDER_BACKBUFFER;
+        RenderTextureDesc size = resources[RENDER_BACKBUFFER].desc;
+        unsigned int fbo = backbufferFbo;
+        if (!backbuffer && (!pass.colourWrites.empty() || pass.depthWrite != RENDER_NO_RESOURCE)) {
+            std::vector<unsigned int> colour;
+            for (RenderResource r : pass.colourWrites) colour.push_back(texture(r));
+            unsigned int depth = 0;
+            GLenum depthFormat = GL_NONE;
+            if (pass.depthWrite != RENDER_NO_RESOURCE) {
+                depth = texture(pass.depthWrite);
+                depthFormat = resources[pass.depthWrite].desc.internalFormat;
+            }
+            fbo = framebufferFor(colour, depth, depthFormat);
+            size = resources[pass.colourWrites.empty() ? pass.depthWrite : pass.colourWrites[0]].desc;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, size.width, size.height);
+        currentFramebuffer = fbo;
+    }
+
+    // Pool entries left idle for a few frames (e.g. after a resize) are
+    // freed along with any framebuffer that references them.
+    void releaseUnused() {
+        for (size_t s = 0; s < pool.size();) {
+            PooledTexture& t = pool[s];
+            t.unusedFrames = t.usedThisFrame ? 0 : t.unusedFrames + 1;
+            if (t.unusedFrames < 3) { ++s; continue; }
+            for (auto it = framebuffers.begin(); it != framebuffers.end();) {
+                if (std::find(it->first.begin(), it->first.end(), t.texture) != it->first.end()) {
+                    glDeleteFramebuffers(1, &it->second);
+                    it = framebuffers.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            glDeleteTextures(1, &t.texture);
+            pool.erase(pool.begin() + s);
+        }
+    }
+};
+
+inline RenderResource RenderPassBuilder::create(const std::string& name, const RenderTextureDesc& desc) {
+    return graph->createTexture(name, desc);
+}
+
+inline void RenderPassBuilder::read(RenderResource resource) {
+    graph->passes[pass].reads.push_back(resource);
+    graph->resources[resource].readers += 1;
+}
+
+inline void RenderPassBuilder::write(RenderResource resource) {
+    graph->passes[pass].colourWrites.push_back(resource);
+    graph->resources[resource].writers.push_back(pass);
+}
+
+inline void RenderPassBuilder::writeDepth(RenderResource resource) {
+    graph->passes[pass].depthWrite = resource;
+    graph->resources[resource].writers.push_back(pass);
+}
+
+inline void RenderPassBuilder::sideEffect() { graph->passes[pass].sideEffect = true; }
+
+inline void RenderPassBuilder::execute(std::function<void(RenderGraph&)> fn) {
+    graph->passes[pass].execute = std::move(fn);
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "ClusteredLighting.h"
+#include "Material.h"
+#include "Mesh.h"
+#include "NormalMatrix.h"
+#include "RenderGraph.h"
+#include "ShaderLibrary.h"
+#include "SimdKernels.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+
+// One draw of a mesh with a world transform and a material table index.
+// The mesh's own texture is bound as the albedo map.
+struct DrawItem {
+    Mesh* mesh = nullptr;
+    glm::mat4 model = glm::mat4(1.0f);
+    int material = 0;
+    bool indexed = false;
+    bool castsShadow = true;
+    bool isStatic = false; // never moves; may be drawn only into cached shadow cascades
+    float boundingRadius = 0.0f; // model-space sphere around the origin for view culling; 0 = never culled
+    TransformKind transform = TRANSFORM_GENERAL; // RIGID for physics bodies; picks the normal matrix shortcut
+};
+
+class CascadedShadows;
+
+// Everything a renderer needs for one frame, independent of how it shades.
+struct RenderScene {
+    std::vector<DrawItem> items;
+    glm::vec3 lightPos = glm::vec3(0.0f);   // main light
+    glm::vec3 lightColor = glm::vec3(1.0f);
+    ClusteredLighting* lights = nullptr;     // dynamic point/spot lights, already updated
+    glm::vec3 sunDirection = glm::vec3(0.0f, -1.0f, 0.0f); // direction the light travels
+    glm::vec3 sunColor = glm::vec3(0.0f);
+    CascadedShadows* shadows = nullptr;      // sun shadows, rendered before the renderer runs
+    RenderResource shadowMap = RENDER_NO_RESOURCE; // set by CascadedShadows::addPass
+};
+
+struct RenderView {
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 position = glm::vec3(0.0f);
+    int width = 800, height = 600;
+    float nearPlane = 0.1f, farPlane = 100.0f;
+};
+
+// Per-frame counters. GPU values lag a few frames behind (query ring).
+struct RenderStats {
+    bool depthPrepass = false;
+    int drawCalls = 0;
+    int depthDrawCalls = 0;
+    int culledItems = 0;     // outside the view frustum, skipped
+    unsigned long long shadedSamples = 0; // samples passing depth in the colour pass
+    double prepassMs = 0.0;
+    double colourMs = 0.0;
+};
+
+// Common interface so the forward and deferred paths can be swapped at
+// startup and compared on the same scene.
+class Renderer {
+public:
+    virtual ~Renderer() {}
+    virtual const char* name() const = 0;
+    // Needs a current context; shader programs are added to the library.
+    virtual void init(ShaderLibrary& shaders, MaterialLibrary& materials) = 0;
+    virtual void resize(int /*width*/, int /*height*/) {}
+    // Leaves depth for the scene in the default framebuffer so overlays
+    // drawn afterwards (light gizmos, debug lines) depth-test correctly.
+    virtual void render(const RenderScene& scene, const RenderView& view) = 0;
+    // Declares the renderer's passes in a frame graph. The default is one
+    // pass drawing straight to the backbuffer through render(). scene and
+    // view must stay alive until the graph has executed.
+    virtual void addPasses(RenderGraph& graph, const RenderScene& scene, const RenderView& view) {
+        RenderPassBuilder pass = graph.addPass(name());
+        if (scene.shadowMap != RENDER_NO_RESOURCE) pass.read(scene.shadowMap);
+        pass.writeBackbuffer();
+        pass.execute([this, &scene, &view](RenderGraph&) { render(scene, view); });
+    }
+    virtual void cleanUp() {}
+    const RenderStats& stats() const { return frameStats; }
+
+protected:
+    RenderStats frameStats;
+    std::vector<unsigned char> visible; // per item, filled by cullItems()
+    std::vector<glm::mat3> normals;     // per item, filled by updateNormalMatrices()
+
+    // Tests every item's bounding sphere, scaled by its largest model axis,
+    // against the view frustum in one batch.
+    void cullItems(const RenderScene& scene, const RenderView& view) {
+        size_t n = scene.items.size();
+        sphereX.resize(n);
+        sphereY.resize(n);
+        sphereZ.resize(n);
+        sphereRadius.resize(n);
+        visible.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            const DrawItem& item = scene.items[i];
+            const glm::mat4& m = item.model;
+            float scale2 = std::max(glm::dot(glm::vec3(m[0]), glm::vec3(m[0])),
+                                    std::max(glm::dot(glm::vec3(m[1]), glm::vec3(m[1])), glm::dot(glm::vec3(m[2]), glm::vec3(m[2]))));
+            sphereX[i] = m[3][0];
+            sphereY[i] = m[3][1];
+            sphereZ[i] = m[3][2];
+            sphereRadius[i] = item.boundingRadius > 0.0f ? item.boundingRadius * std::sqrt(scale2) : 1e30f;
+        }
+        if (n) cullSpheres(frustumFromMatrix(view.projection * view.view), sphereX.data(), sphereY.data(),
+                           sphereZ.data(), sphereRadius.data(), n, visible.data());
+        frameStats.culledItems = int(std::count(visible.begin(), visible.end(), 0));
+    }
+
+    // One batch per transform kind, so rigid and uniformly scaled items
+    // take the cheap path and only general ones pay for the inverse.
+    void updateNormalMatrices(const RenderScene& scene) {
+        normals.resize(scene.items.size());
+        for (int kind = TRANSFORM_GENERAL; kind <= TRANSFORM_RIGID; ++kind) {
+            batchItems.clear();
+            batchModels.clear();
+            for (size_t i = 0; i < scene.items.size(); ++i) {
+                if (scene.items[i].transform != kind) continue;
+                batchItems.push_back(i);
+                batchModels.push_back(scene.items[i].model);
+            }
+            if (batchItems.empty()) continue;
+            batchNormals.resize(batchItems.size());
+            computeNormalMatrices(batchModels.data(), batchNormals.data(), batchModels.size(), TransformKind(kind));
+            for (size_t k = 0; k < batchItems.size(); ++k) normals[batchItems[k]] = batchNormals[k];
+        }
+    }
+
+private:
+    std::vector<float> sphereX, sphereY, sphereZ, sphereRadius;
+    std::vector<size_t> batchItems;
+    std::vector<glm::mat4> batchModels;
+    std::vector<glm::mat3> batchNormals;
+};
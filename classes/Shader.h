@@ -1,7 +1,9 @@
+#pragma once
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glad/glad.h> // include glad to get the required OpenGL headers
+#include "ShaderCache.h"
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -12,28 +14,40 @@ public:
     unsigned int programID;
 
     Shader(const char* vertexShaderSource, const char* fragmentShaderSource) {
-        // compile vertex shader
-        unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-        glCompileShader(vertexShader);
-        checkCompileErrors(vertexShader, "VERTEX");
+        compileAndLink(vertexShaderSource, fragmentShaderSource, nullptr);
+    }
 
-        // compile fragment shader
-        unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-        glCompileShader(fragmentShader);
-        checkCompileErrors(fragmentShader, "FRAGMENT");
+    // Wraps an already linked program (cache hit, ShaderLibrary variant)
+    explicit Shader(unsigned int linkedProgram) : programID(linkedProgram) {}
 
-        // link shaders
-        programID = glCreateProgram();
-        glAttachShader(programID, vertexShader);
-        glAttachShader(programID, fragmentShader);
-        glLinkProgram(programID);
-        checkCompileErrors(programID, "PROGRAM");
+    // Restores the linked program from the cache when possible, otherwise
+    // compiles (with defines injected after #version) and stores the result.
+    Shader(const char* vertexShaderSource, const char* fragmentShaderSource,
+           ShaderCache& cache, const std::string& defines = "") {
+        programID = cache.load(vertexShaderSource, fragmentShaderSource, defines);
+        if (programID) return;
 
-        // delete shaders after linking
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+        std::string vs = injectDefines(vertexShaderSource, defines);
+        std::string fs = injectDefines(fragmentShaderSource, defines);
+        if (compileAndLink(vs.c_str(), fs.c_str(), &cache))
+            cache.store(programID, vertexShaderSource, fragmentShaderSource, defines);
+    }
+
+    // Inserts a block of "#define X" lines after the #version directive,
+    // which GLSL requires to stay first.
+    static std::string injectDefines(const char* source, const std::string& defines) {
+        std::string s = source;
+        if (defines.empty()) return s;
+        size_t version = s.find("#version");
+        size_t insertAt = 0;
+        if (version != std::string::npos) {
+            size_t eol = s.find('\n', version);
+            insertAt = (eol == std::string::npos) ? s.size() : eol + 1;
+        }
+        std::string block = defines;
+        if (block.back() != '\n') block += '\n';
+        s.insert(insertAt, block);
+        return s;
     }
 
     void use() {
@@ -44,6 +58,10 @@ public:
         glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
     }
 
+    void setMat3(const std::string &name, const glm::mat3 &mat) const {
+        glUniformMatrix3fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    }
+
     void setVec3(const std::string &name, const glm::vec3 &value) const {
         glUniform3fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
     }
@@ -61,7 +79,34 @@ public:
     }
 
 private:
-    void checkCompileErrors(unsigned int shader, std::string type) {
+    bool compileAndLink(const char* vertexShaderSource, const char* fragmentShaderSource, ShaderCache* cache) {
+        // compile vertex shader
+        unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+        glCompileShader(vertexShader);
+        checkCompileErrors(vertexShader, "VERTEX");
+
+        // compile fragment shader
+        unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+        glCompileShader(fragmentShader);
+        checkCompileErrors(fragmentShader, "FRAGMENT");
+
+        // link shaders
+        programID = glCreateProgram();
+        glAttachShader(programID, vertexShader);
+        glAttachShader(programID, fragmentShader);
+        if (cache) cache->markRetrievable(programID);
+        glLinkProgram(programID);
+        bool linked = checkCompileErrors(programID, "PROGRAM");
+
+        // delete shaders after linking
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return linked;
+    }
+
+    bool checkCompileErrors(unsigned int shader, std::string type) {
         int success;
         char infoLog[1024];
 
@@ -80,6 +125,7 @@ private:
                           << infoLog << std::endl;
             }
         }
+        return success != 0;
     }
 };
 
@@ -0,0 +1,139 @@
+#pragma once
+#include "GLExtensions.h"
+#include "Hash.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries. Entries are keyed by the shader
+// sources, the variant defines and the driver identity (vendor, renderer,
+// version), so a driver update or a different GPU simply misses instead of
+// loading a blob the driver cannot use.
+class ShaderCache {
+public:
+    explicit ShaderCache(const std::string& directory = "shader_cache") : directory(directory) {}
+
+    // Needs a current context; call once after gladLoadGLLoader.
+    bool init() {
+        api.load();
+        if (!api.available) return false;
+        driver.clear();
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* s = reinterpret_cast<const char*>(glGetString(name));
+            driver += s ? s : "";
+            driver += '\n';
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        return true;
+    }
+
+    bool enabled() const { return api.available; }
+
+    // Must be set before linking or some drivers will not return a binary.
+    void markRetrievable(unsigned int program) const {
+        if (api.available) api.programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // Linked program restored from disk, or 0 on a miss or a rejected blob.
+    unsigned int load(const char* vertexSource, const char* fragmentSource, const std::string& defines) {
+        if (!api.available) return 0;
+        uint64_t key = hashKey(vertexSource, fragmentSource, defines);
+        std::string path = pathFor(key);
+
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return 0;
+        FileHeader header;
+        std::vector<char> blob;
+        bool ok = std::fread(&header, sizeof(header), 1, f) == 1 &&
+                  std::memcmp(header.magic, "SHBC", 4) == 0 && header.key == key && header.length > 0;
+        if (ok) {
+            blob.resize(header.length);
+            ok = std::fread(blob.data(), 1, blob.size(), f) == blob.size();
+        }
+        std::fclose(f);
+
+        unsigned int program = 0;
+        if (ok) {
+            program = glCreateProgram();
+            api.programBinary(program, header.format, blob.data(), static_cast<GLsizei>(blob.size()));
+            GLint linked = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            if (!linked) {
+                glDeleteProgram(program);
+                program = 0;
+            }
+        }
+        if (!program) std::remove(path.c_str()); // stale or corrupt: recompile and rewrite
+        return program;
+    }
+
+    void store(unsigned int program, const char* vertexSource, const char* fragmentSource, const std::string& defines) {
+        if (!api.available) return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+
+        std::vector<char> blob(length);
+        FileHeader header;
+        std::memcpy(header.magic, "SHBC", 4);
+        header.key = hashKey(vertexSource, fragmentSource, defines);
+        GLsizei written = 0;
+        api.getProgramBinary(program, length, &written, &header.format, blob.data());
+        if (written <= 0) return;
+        header.length = static_cast<uint32_t>(written);
+
+        // write then rename so a crash never leaves a truncated entry behind
+        std::string path = pathFor(header.key);
+        std::string temp = path + ".tmp";
+        FILE* f = std::fopen(temp.c_str(), "wb");
+        if (!f) return;
+        bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+                  std::fwrite(blob.data(), 1, header.length, f) == header.length;
+        ok = (std::fclose(f) == 0) && ok;
+        std::error_code ec;
+        if (ok) std::filesystem::rename(temp, path, ec);
+        if (!ok || ec) {
+            std::remove(temp.c_str());
+            std::cout << "WARNING::SHADER_CACHE::WRITE_FAILED " << path << std::endl;
+        }
+    }
+
+private:
+    struct FileHeader {
+        char magic[4];
+        GLenum format;
+        uint64_t key;
+        uint32_t length;
+        uint32_t reserved = 0;
+    };
+
+    std::string directory;
+    std::string driver;
+    GLProgramBinaryAPI api;
+
+    uint64_t hashKey(const char* vertexSource, const char* fragmentSource, const std::string& defines) const {
+        uint64_t h = FNV1A_SEED;
+        auto mix = [&h](const char* s, size_t n) {
+            static const unsigned char separator = 0xFF;
+            h = fnv1a(s, n, h);
+            h = fnv1a(&separator, 1, h);
+        };
+        mix(vertexSource, std::strlen(vertexSource));
+        mix(fragmentSource, std::strlen(fragmentSource));
+        mix(defines.data(), defines.size());
+        mix(driver.data(), driver.size());
+        return h;
+    }
+
+    std::string pathFor(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(directory) / name).string();
+    }
+};
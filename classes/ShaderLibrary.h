@@ -0,0 +1,292 @@
+#pragma once
+#include "GLExtensions.h"
+#include "Shader.h"
+#include "ShaderCache.h"
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Feature flags turned into #defines at the top of each variant.
+enum ShaderFeature : uint32_t {
+    SHADER_INSTANCING    = 1u << 0,
+    SHADER_TEXTURE_ARRAY = 1u << 1,
+    SHADER_NORMAL_MAP    = 1u << 2,
+    SHADER_SHADOWS       = 1u << 3,
+    SHADER_CLUSTERED_LIGHTS = 1u << 4,
+};
+
+// Features that change the vertex inputs; a fallback must match these or
+// it would read the wrong attributes.
+static const uint32_t SHADER_STRUCTURAL_FEATURES = SHADER_INSTANCING;
+
+// Loads shader sources from files and builds feature permutations on demand.
+// Requesting a variant that is not ready starts compiling it and returns the
+// closest ready variant instead, so draws never wait on the compiler. With
+// KHR_parallel_shader_compile the driver compiles in the background and
+// update() polls for completion; without it update() finishes at most one
+// variant per call to spread the cost over frames.
+class ShaderLibrary {
+public:
+    typedef uint32_t ProgramId;
+
+    explicit ShaderLibrary(const std::string& directory, ShaderCache* cache = nullptr)
+        : directory(directory), cache(cache) {}
+
+    // Needs a current context.
+    void init() { parallel.load(); }
+
+    bool parallelCompile() const { return parallel.available; }
+
+    ProgramId add(const std::string& name, const std::string& vertexFile, const std::string& fragmentFile) {
+        Program p;
+        p.name = name;
+        p.vertexSource = expandIncludes(readFile(directory + "/" + vertexFile));
+        p.fragmentSource = expandIncludes(readFile(directory + "/" + fragmentFile));
+        programs.push_back(p);
+        return static_cast<ProgramId>(programs.size() - 1);
+    }
+
+    // Starts background compilation without drawing with the variant yet.
+    void prefetch(ProgramId program, uint32_t features) { variant(program, features); }
+
+    // Requested variant if ready, otherwise the best ready fallback. Returns
+    // nullptr when no compatible variant builds (the failure is logged once
+    // when it happens), so callers skip their pass.
+    Shader* get(ProgramId program, uint32_t features) {
+        Variant& requested = variant(program, features);
+        if (requested.state == READY) return requested.shader.get();
+
+        Shader* best = nullptr;
+        int bestBits = -1;
+        uint32_t structural = features & SHADER_STRUCTURAL_FEATURES;
+        for (auto& v : variants) {
+            uint32_t mask = static_cast<uint32_t>(v.first);
+            if ((v.first >> 32) != program || v.second.state != READY) continue;
+            if ((mask & ~features) != 0 || (mask & SHADER_STRUCTURAL_FEATURES) != structural) continue;
+            int bits = popcount(mask);
+            if (bits > bestBits) { best = v.second.shader.get(); bestBits = bits; }
+        }
+        if (best) return best;
+
+        // nothing usable yet: build the minimal compatible variant now
+        Variant& base = variant(program, structural);
+        finish(base, program, structural);
+        return base.state == READY ? base.shader.get() : nullptr;
+    }
+
+    bool isReady(ProgramId program, uint32_t features) {
+        auto it = variants.find(key(program, features));
+        return it != variants.end() && it->second.state == READY;
+    }
+
+    // Call once per frame.
+    void update() {
+        size_t count = compiling.size();
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t k = compiling.front();
+            compiling.pop_front();
+            Variant& v = variants[k];
+            ProgramId program = static_cast<ProgramId>(k >> 32);
+            uint32_t features = static_cast<uint32_t>(k);
+
+            if (parallel.available) {
+                if (v.state == QUEUED) start(v, program, features);
+                GLint done = GL_FALSE;
+                glGetProgramiv(v.program, GL_COMPLETION_STATUS_KHR, &done);
+                if (done) finish(v, program, features);
+                else compiling.push_back(k);
+            } else if (i == 0) {
+                finish(v, program, features);
+            } else {
+                compiling.push_back(k);
+            }
+        }
+    }
+
+    size_t pendingCount() const { return compiling.size(); }
+
+    // Deletes every variant; call while the context is still alive.
+    void cleanUp() {
+        for (auto& v : variants) {
+            if (v.second.shader) glDeleteProgram(v.second.shader->programID);
+            if (v.second.program) glDeleteProgram(v.second.program);
+            if (v.second.vertexShader) glDeleteShader(v.second.vertexShader);
+            if (v.second.fragmentShader) glDeleteShader(v.second.fragmentShader);
+        }
+        variants.clear();
+        compiling.clear();
+    }
+
+    static std::string definesFor(uint32_t features) {
+        std::string d;
+        if (features & SHADER_INSTANCING)    d += "#define INSTANCING\n";
+        if (features & SHADER_TEXTURE_ARRAY) d += "#define TEXTURE_ARRAY\n";
+        if (features & SHADER_NORMAL_MAP)    d += "#define NORMAL_MAP\n";
+        if (features & SHADER_SHADOWS)       d += "#define SHADOWS\n";
+        if (features & SHADER_CLUSTERED_LIGHTS) d += "#define CLUSTERED_LIGHTS\n";
+        return d;
+    }
+
+private:
+    enum State { QUEUED, COMPILING, READY, FAILED };
+
+    struct Program {
+        std::string name;
+        std::string vertexSource;
+        std::string fragmentSource;
+    };
+
+    struct Variant {
+        State state = QUEUED;
+        unsigned int program = 0;
+        unsigned int vertexShader = 0;
+        unsigned int fragmentShader = 0;
+        std::unique_ptr<Shader> shader;
+    };
+
+    std::string directory;
+    ShaderCache* cache;
+    GLParallelCompileAPI parallel;
+    std::vector<Program> programs;
+    std::unordered_map<uint64_t, Variant> variants;
+    std::deque<uint64_t> compiling;
+
+    static uint64_t key(ProgramId program, uint32_t features) {
+        return (static_cast<uint64_t>(program) << 32) | features;
+    }
+
+    static int popcount(uint32_t x) {
+        int n = 0;
+        for (; x; x &= x - 1) ++n;
+        return n;
+    }
+
+    static std::string readFile(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cout << "ERROR::SHADER_LIBRARY::FILE_NOT_FOUND " << path << std::endl;
+            return std::string();
+        }
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+    // Replaces each #include "file" line with that file from the shader
+    // directory, so programs share one copy of common code (lighting.glsl).
+    // Expanded once at add(); the feature defines are injected after
+    // #version later, so included code sees them like the rest.
+    std::string expandIncludes(const std::string& source, int depth = 0) const {
+        if (depth > 8) {
+            std::cout << "ERROR::SHADER_LIBRARY::INCLUDE_DEPTH" << std::endl;
+            return source;
+        }
+        std::string out;
+        size_t start = 0;
+        while (start < source.size()) {
+            size_t eol = source.find('\n', start);
+            size_t end = eol == std::string::npos ? source.size() : eol + 1;
+            size_t first = source.find_first_not_of(" \t", start);
+            size_t open = std::string::npos, close = std::string::npos;
+            if (first < end && source.compare(first, 8, "#include") == 0) {
+                open = source.find('"', first);
+                close = open < end ? source.find('"', open + 1) : std::string::npos;
+            }
+            if (close < end) {
+                std::string name = source.substr(open + 1, close - open - 1);
+                out += expandIncludes(readFile(directory + "/" + name), depth + 1);
+                if (!out.empty() && out.back() != '\n') out += '\n';
+            } else {
+                out.append(source, start, end - start);
+            }
+            start = end;
+        }
+        return out;
+    }
+
+    Variant& variant(ProgramId program, uint32_t features) {
+        uint64_t k = key(program, features);
+        auto it = variants.find(k);
+        if (it != variants.end()) return it->second;
+
+        Variant& v = variants[k];
+        const Program& p = programs[program];
+        std::string defines = definesFor(features);
+        if (cache) {
+            unsigned int cached = cache->load(p.vertexSource.c_str(), p.fragmentSource.c_str(), defines);
+            if (cached) {
+                v.shader.reset(new Shader(cached));
+                v.state = READY;
+                return v;
+            }
+        }
+        // with the extension the driver starts right away; otherwise wait for update()
+        if (parallel.available) start(v, program, features);
+        compiling.push_back(k);
+        return v;
+    }
+
+    void start(Variant& v, ProgramId program, uint32_t features) {
+        const Program& p = programs[program];
+        std::string defines = definesFor(features);
+        std::string vs = Shader::injectDefines(p.vertexSource.c_str(), defines);
+        std::string fs = Shader::injectDefines(p.fragmentSource.c_str(), defines);
+        const char* vsPtr = vs.c_str();
+        const char* fsPtr = fs.c_str();
+
+        v.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(v.vertexShader, 1, &vsPtr, NULL);
+        glCompileShader(v.vertexShader);
+        v.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(v.fragmentShader, 1, &fsPtr, NULL);
+        glCompileShader(v.fragmentShader);
+
+        v.program = glCreateProgram();
+        glAttachShader(v.program, v.vertexShader);
+        glAttachShader(v.program, v.fragmentShader);
+        if (cache) cache->markRetrievable(v.program);
+        glLinkProgram(v.program); // no status query here, that would block
+        v.state = COMPILING;
+    }
+
+    // Blocks if the driver is still working on it.
+    void finish(Variant& v, ProgramId program, uint32_t features) {
+        if (v.state == READY || v.state == FAILED) return;
+        if (v.state == QUEUED) start(v, program, features);
+
+        const Program& p = programs[program];
+        GLint linked = GL_FALSE;
+        glGetProgramiv(v.program, GL_LINK_STATUS, &linked);
+        if (linked) {
+            v.shader.reset(new Shader(v.program));
+            v.state = READY;
+            if (cache) cache->store(v.program, p.vertexSource.c_str(), p.fragmentSource.c_str(), definesFor(features));
+        } else {
+            char infoLog[1024];
+            glGetShaderInfoLog(v.vertexShader, 1024, NULL, infoLog);
+            std::cout << "ERROR::SHADER_LIBRARY::VARIANT_FAILED " << p.name << " features=" << features << "\n"
+                      << infoLog;
+            glGetShaderInfoLog(v.fragmentShader, 1024, NULL, infoLog);
+            std::cout << infoLog;
+            glGetProgramInfoLog(v.program, 1024, NULL, infoLog);
+            std::cout << infoLog << std::endl;
+            glDeleteProgram(v.program);
+            v.state = FAILED;
+        }
+        glDeleteShader(v.vertexShader);
+        glDeleteShader(v.fragmentShader);
+        v.program = v.vertexShader = v.fragmentShader = 0;
+
+        // drop it from the compile queue if it was finished out of band
+        uint64_t k = key(program, features);
+        for (auto it = compiling.begin(); it != compiling.end(); ++it)
+            if (*it == k) { compiling.erase(it); break; }
+    }
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include "CpuFeatures.h"
+#include "Frustum.h"
+#include "PhysicsIntegrator.h"
+#include "SimdWide.h"
+
+#include <cstddef>
+
+// Hot math kernels (integration, pose matrices, body bounds, frustum
+// culling) compiled for every instruction set in one binary and picked at
+// startup from simdLevel(). SimdKernels.inl holds the single source; it is
+// included below once per set.
+
+// Position + orientation streams of a set of bodies.
+struct PoseStreams {
+    const float *px, *py, *pz;
+    const float *qx, *qy, *qz, *qw;
+};
+
+struct BoundsStreams {
+    float *minX, *minY, *minZ;
+    float *maxX, *maxY, *maxZ;
+};
+
+namespace simd_scalar {
+typedef SimdScalar S;
+#include "SimdKernels.inl"
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET_BEGIN("sse2")
+namespace simd_sse2 {
+typedef SimdSse2 S;
+#include "SimdKernels.inl"
+}
+SIMD_TARGET_END
+
+SIMD_TARGET_BEGIN("avx2,fma")
+namespace simd_avx2 {
+typedef SimdAvx2 S;
+#include "SimdKernels.inl"
+}
+SIMD_TARGET_END
+
+SIMD_TARGET_BEGIN("avx512f,avx2,fma")
+namespace simd_avx512 {
+typedef SimdAvx512 S;
+#include "SimdKernels.inl"
+}
+SIMD_TARGET_END
+#endif
+
+struct SimdKernelTable {
+    SimdLevel level;
+    void (*integrateBodies)(const BodyArrays&, const IntegrationParams&);
+    void (*blendPoseMatrices)(const PoseStreams&, const PoseStreams&, float, size_t, float*);
+    void (*updateBodyBounds)(const PoseStreams&, const float*, const float*, const float*, const BoundsStreams&, size_t);
+    void (*cullSpheres)(const Frustum&, const float*, const float*, const float*, const float*, size_t, unsigned char*);
+};
+
+#define SIMD_KERNEL_TABLE(level, ns) \
+    { level, ns::integrateBodies, ns::blendPoseMatrices, ns::updateBodyBounds, ns::cullSpheres }
+
+inline const SimdKernelTable& simdKernels() {
+    static const SimdKernelTable table = [] {
+        SimdKernelTable scalar = SIMD_KERNEL_TABLE(SIMD_SCALAR, simd_scalar);
+        // the scalar integrator is the reference path, not the S = float instantiation
+        scalar.integrateBodies = integrateBodiesScalar;
+#ifdef SIMD_X86
+        switch (simdLevel()) {
+            case SIMD_AVX512: return SimdKernelTable(SIMD_KERNEL_TABLE(SIMD_AVX512, simd_avx512));
+            case SIMD_AVX2: return SimdKernelTable(SIMD_KERNEL_TABLE(SIMD_AVX2, simd_avx2));
+            case SIMD_SSE2: return SimdKernelTable(SIMD_KERNEL_TABLE(SIMD_SSE2, simd_sse2));
+            default: break;
+        }
+#endif
+        return scalar;
+    }();
+    return table;
+}
+
+#undef SIMD_KERNEL_TABLE
+
+inline void integrateBodies(const BodyArrays& b, const IntegrationParams& p) {
+    simdKernels().integrateBodies(b, p);
+}
+
+inline void blendPoseMatrices(const PoseStreams& prev, const PoseStreams& cur, float t, size_t count, float* out) {
+    simdKernels().blendPoseMatrices(prev, cur, t, count, out);
+}
+
+inline void updateBodyBounds(const PoseStreams& pose, const float* hx, const float* hy, const float* hz,
+                             const BoundsStreams& out, size_t padded) {
+    simdKernels().updateBodyBounds(pose, hx, hy, hz, out, padded);
+}
+
+inline void cullSpheres(const Frustum& frustum, const float* cx, const float* cy, const float* cz,
+                        const float* radius, size_t count, unsigned char* visible) {
+    simdKernels().cullSpheres(frustum, cx, cy, cz, radius, count, visible);
+}
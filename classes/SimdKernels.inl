@@ -0,0 +1,169 @@
+// Kernel bodies shared by every instruction set. SimdKernels.h includes this
+// file once per set, each time inside its own namespace with `S` naming the
+// lane wrapper and inside that set's target region, so the same source
+// becomes scalar, SSE2, AVX2 and AVX-512 functions. No includes here.
+
+// Semi-implicit Euler, S::WIDTH bodies at a time over the padded range (see
+// integrateBodiesScalar for the reference). Padding lanes hold inert bodies
+// so no scalar tail is needed; the dynamic/kinematic branch is a select.
+inline void integrateBodies(const BodyArrays& b, const IntegrationParams& p) {
+    typedef S::F F;
+    const F zero = S::set1(0.0f), one = S::set1(1.0f), two = S::set1(2.0f);
+    const F dt = S::set1(p.dt), halfDt = S::set1(0.5f * p.dt);
+    const F gravityX = S::set1(p.gravityX), gravityY = S::set1(p.gravityY), gravityZ = S::set1(p.gravityZ);
+    const F linearScale = S::set1(p.linearScale), angularScale = S::set1(p.angularScale);
+
+    for (size_t i = 0; i < b.padded; i += S::WIDTH) {
+        F x = S::load(b.qx + i), y = S::load(b.qy + i), z = S::load(b.qz + i), w = S::load(b.qw + i);
+        F im = S::load(b.invMass + i);
+        S::Mask dynamic = S::greater(im, zero);
+        F lin = S::select(dynamic, linearScale, one);
+        F ang = S::select(dynamic, angularScale, one);
+
+        // linear velocity
+        F vx = S::mul(S::fmadd(S::fmadd(S::load(b.fx + i), im, S::select(dynamic, gravityX, zero)), dt, S::load(b.vx + i)), lin);
+        F vy = S::mul(S::fmadd(S::fmadd(S::load(b.fy + i), im, S::select(dynamic, gravityY, zero)), dt, S::load(b.vy + i)), lin);
+        F vz = S::mul(S::fmadd(S::fmadd(S::load(b.fz + i), im, S::select(dynamic, gravityZ, zero)), dt, S::load(b.vz + i)), lin);
+
+        // angular velocity; kinematic lanes have zero inverse inertia
+        F tx = S::load(b.tx + i), ty = S::load(b.ty + i), tz = S::load(b.tz + i);
+        F cx = S::mul(two, S::fnmadd(y, tz, S::mul(z, ty)));
+        F cy = S::mul(two, S::fnmadd(z, tx, S::mul(x, tz)));
+        F cz = S::mul(two, S::fnmadd(x, ty, S::mul(y, tx)));
+        F lx = S::mul(S::sub(S::fmadd(w, cx, tx), S::fnmadd(z, cy, S::mul(y, cz))), S::load(b.iix + i));
+        F ly = S::mul(S::sub(S::fmadd(w, cy, ty), S::fnmadd(x, cz, S::mul(z, cx))), S::load(b.iiy + i));
+        F lz = S::mul(S::sub(S::fmadd(w, cz, tz), S::fnmadd(y, cx, S::mul(x, cy))), S::load(b.iiz + i));
+        cx = S::mul(two, S::fnmadd(z, ly, S::mul(y, lz)));
+        cy = S::mul(two, S::fnmadd(x, lz, S::mul(z, lx)));
+        cz = S::mul(two, S::fnmadd(y, lx, S::mul(x, ly)));
+        F ax = S::add(S::fmadd(w, cx, lx), S::fnmadd(z, cy, S::mul(y, cz)));
+        F ay = S::add(S::fmadd(w, cy, ly), S::fnmadd(x, cz, S::mul(z, cx)));
+        F az = S::add(S::fmadd(w, cz, lz), S::fnmadd(y, cx, S::mul(x, cy)));
+        F wx = S::mul(S::fmadd(ax, dt, S::load(b.wx + i)), ang);
+        F wy = S::mul(S::fmadd(ay, dt, S::load(b.wy + i)), ang);
+        F wz = S::mul(S::fmadd(az, dt, S::load(b.wz + i)), ang);
+
+        S::store(b.vx + i, vx); S::store(b.vy + i, vy); S::store(b.vz + i, vz);
+        S::store(b.wx + i, wx); S::store(b.wy + i, wy); S::store(b.wz + i, wz);
+        S::store(b.px + i, S::fmadd(vx, dt, S::load(b.px + i)));
+        S::store(b.py + i, S::fmadd(vy, dt, S::load(b.py + i)));
+        S::store(b.pz + i, S::fmadd(vz, dt, S::load(b.pz + i)));
+
+        // orientation
+        F hx = S::mul(halfDt, wx), hy = S::mul(halfDt, wy), hz = S::mul(halfDt, wz);
+        F nx = S::fnmadd(hz, y, S::fmadd(hy, z, S::fmadd(hx, w, x)));
+        F ny = S::fnmadd(hx, z, S::fmadd(hz, x, S::fmadd(hy, w, y)));
+        F nz = S::fnmadd(hy, x, S::fmadd(hx, y, S::fmadd(hz, w, z)));
+        F nw = S::fnmadd(hz, z, S::fnmadd(hy, y, S::fnmadd(hx, x, w)));
+        F len2 = S::fmadd(nw, nw, S::fmadd(nz, nz, S::fmadd(ny, ny, S::mul(nx, nx))));
+        F inv = S::div(one, S::sqrt(len2));
+        S::store(b.qx + i, S::mul(nx, inv)); S::store(b.qy + i, S::mul(ny, inv));
+        S::store(b.qz + i, S::mul(nz, inv)); S::store(b.qw + i, S::mul(nw, inv));
+
+        S::store(b.fx + i, zero); S::store(b.fy + i, zero); S::store(b.fz + i, zero);
+        S::store(b.tx + i, zero); S::store(b.ty + i, zero); S::store(b.tz + i, zero);
+    }
+}
+
+// Rotation rows of S::WIDTH unit quaternions: r[row * 3 + col].
+inline void quaternionRows(S::F x, S::F y, S::F z, S::F w, S::F* r) {
+    typedef S::F F;
+    const F one = S::set1(1.0f), two = S::set1(2.0f);
+    F xx = S::mul(x, x), yy = S::mul(y, y), zz = S::mul(z, z);
+    F xy = S::mul(x, y), xz = S::mul(x, z), yz = S::mul(y, z);
+    F wx = S::mul(w, x), wy = S::mul(w, y), wz = S::mul(w, z);
+    r[0] = S::fnmadd(two, S::add(yy, zz), one); r[1] = S::mul(two, S::sub(xy, wz)); r[2] = S::mul(two, S::add(xz, wy));
+    r[3] = S::mul(two, S::add(xy, wz)); r[4] = S::fnmadd(two, S::add(xx, zz), one); r[5] = S::mul(two, S::sub(yz, wx));
+    r[6] = S::mul(two, S::sub(xz, wy)); r[7] = S::mul(two, S::add(yz, wx)); r[8] = S::fnmadd(two, S::add(xx, yy), one);
+}
+
+// Column-major 4x4 model matrices (16 floats each) for `count` poses at
+// prev + (cur - prev) * t; orientations are nlerped along the shorter arc.
+// t in [0, 1] interpolates, t > 1 extrapolates. Inputs are padded streams.
+inline void blendPoseMatrices(const PoseStreams& prev, const PoseStreams& cur, float t, size_t count, float* out) {
+    typedef S::F F;
+    const F zero = S::set1(0.0f), one = S::set1(1.0f), minusOne = S::set1(-1.0f);
+    const F vt = S::set1(t), vs = S::set1(1.0f - t);
+    alignas(64) float lanes[12][S::WIDTH];
+
+    for (size_t i = 0; i < count; i += S::WIDTH) {
+        F ax = S::load(prev.qx + i), ay = S::load(prev.qy + i), az = S::load(prev.qz + i), aw = S::load(prev.qw + i);
+        F bx = S::load(cur.qx + i), by = S::load(cur.qy + i), bz = S::load(cur.qz + i), bw = S::load(cur.qw + i);
+        F dot = S::fmadd(aw, bw, S::fmadd(az, bz, S::fmadd(ay, by, S::mul(ax, bx))));
+        F tb = S::mul(vt, S::select(S::greater(zero, dot), minusOne, one));
+        F x = S::fmadd(bx, tb, S::mul(ax, vs)), y = S::fmadd(by, tb, S::mul(ay, vs));
+        F z = S::fmadd(bz, tb, S::mul(az, vs)), w = S::fmadd(bw, tb, S::mul(aw, vs));
+        F len2 = S::fmadd(w, w, S::fmadd(z, z, S::fmadd(y, y, S::mul(x, x))));
+        F inv = S::div(one, S::sqrt(len2));
+        F r[9];
+        quaternionRows(S::mul(x, inv), S::mul(y, inv), S::mul(z, inv), S::mul(w, inv), r);
+
+        // column-major: m[col][row] = r[row * 3 + col]
+        for (int col = 0; col < 3; ++col)
+            for (int row = 0; row < 3; ++row) S::store(lanes[col * 3 + row], r[row * 3 + col]);
+        F px = S::load(prev.px + i), py = S::load(prev.py + i), pz = S::load(prev.pz + i);
+        S::store(lanes[9], S::fmadd(S::sub(S::load(cur.px + i), px), vt, px));
+        S::store(lanes[10], S::fmadd(S::sub(S::load(cur.py + i), py), vt, py));
+        S::store(lanes[11], S::fmadd(S::sub(S::load(cur.pz + i), pz), vt, pz));
+
+        size_t n = count - i < S::WIDTH ? count - i : S::WIDTH;
+        for (size_t l = 0; l < n; ++l) {
+            float* m = out + (i + l) * 16;
+            m[0] = lanes[0][l]; m[1] = lanes[1][l]; m[2] = lanes[2][l]; m[3] = 0.0f;
+            m[4] = lanes[3][l]; m[5] = lanes[4][l]; m[6] = lanes[5][l]; m[7] = 0.0f;
+            m[8] = lanes[6][l]; m[9] = lanes[7][l]; m[10] = lanes[8][l]; m[11] = 0.0f;
+            m[12] = lanes[9][l]; m[13] = lanes[10][l]; m[14] = lanes[11][l]; m[15] = 1.0f;
+        }
+    }
+}
+
+// World AABBs of oriented boxes: extent along world axis k is
+// sum_j |R[k][j]| * halfExtent[j]. Padded streams in and out.
+inline void updateBodyBounds(const PoseStreams& pose, const float* hx, const float* hy, const float* hz,
+                             const BoundsStreams& out, size_t padded) {
+    typedef S::F F;
+    for (size_t i = 0; i < padded; i += S::WIDTH) {
+        F r[9];
+        quaternionRows(S::load(pose.qx + i), S::load(pose.qy + i), S::load(pose.qz + i), S::load(pose.qw + i), r);
+        F h0 = S::load(hx + i), h1 = S::load(hy + i), h2 = S::load(hz + i);
+        F ex = S::fmadd(S::abs(r[2]), h2, S::fmadd(S::abs(r[1]), h1, S::mul(S::abs(r[0]), h0)));
+        F ey = S::fmadd(S::abs(r[5]), h2, S::fmadd(S::abs(r[4]), h1, S::mul(S::abs(r[3]), h0)));
+        F ez = S::fmadd(S::abs(r[8]), h2, S::fmadd(S::abs(r[7]), h1, S::mul(S::abs(r[6]), h0)));
+        F px = S::load(pose.px + i), py = S::load(pose.py + i), pz = S::load(pose.pz + i);
+        S::store(out.minX + i, S::sub(px, ex)); S::store(out.maxX + i, S::add(px, ex));
+        S::store(out.minY + i, S::sub(py, ey)); S::store(out.maxY + i, S::add(py, ey));
+        S::store(out.minZ + i, S::sub(pz, ez)); S::store(out.maxZ + i, S::add(pz, ez));
+    }
+}
+
+// visible[i] = 1 when sphere i touches the frustum. Any count and alignment.
+inline void cullSpheres(const Frustum& frustum, const float* cx, const float* cy, const float* cz,
+                        const float* radius, size_t count, unsigned char* visible) {
+    typedef S::F F;
+    const F zero = S::set1(0.0f), one = S::set1(1.0f);
+    F plane[6][4];
+    for (int p = 0; p < 6; ++p)
+        for (int c = 0; c < 4; ++c) plane[p][c] = S::set1(frustum.planes[p][c]);
+
+    size_t i = 0;
+    alignas(64) float lanes[S::WIDTH];
+    for (; i + S::WIDTH <= count; i += S::WIDTH) {
+        F x = S::loadu(cx + i), y = S::loadu(cy + i), z = S::loadu(cz + i), r = S::loadu(radius + i);
+        // smallest signed distance to any plane, pushed out by the radius
+        F nearest = S::set1(1e30f);
+        for (int p = 0; p < 6; ++p) {
+            F d = S::fmadd(plane[p][2], z, S::fmadd(plane[p][1], y, S::fmadd(plane[p][0], x, plane[p][3])));
+            nearest = S::min(nearest, S::add(d, r));
+        }
+        S::store(lanes, S::select(S::greater(zero, nearest), zero, one));
+        for (size_t l = 0; l < S::WIDTH; ++l) visible[i + l] = lanes[l] != 0.0f;
+    }
+    for (; i < count; ++i) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; ++p) {
+            const float* pl = frustum.planes[p];
+            inside = pl[0] * cx[i] + pl[1] * cy[i] + pl[2] * cz[i] + pl[3] + radius[i] >= 0.0f;
+        }
+        visible[i] = inside;
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+// Thin wrappers giving scalar code, SSE2 (4 lanes), AVX2 (8 lanes) and
+// AVX-512 (16 lanes) the same static interface, so a kernel is written once
+// against `S` and compiled per instruction set (see SimdKernels.h). Aligned
+// load/store expect AlignedArray streams padded to a multiple of the widest
+// lane count; loadu/storeu take any pointer.
+//
+// The wider sets are compiled with per-function target attributes rather
+// than -m flags, so one binary carries every variant and the baseline code
+// stays runnable on any x86-64 CPU. SIMD_TARGET_BEGIN/END bracket a region
+// whose functions all get the given target.
+#define SIMD_PRAGMA(x) _Pragma(#x)
+#if defined(__clang__)
+#define SIMD_TARGET_BEGIN(isa) SIMD_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define SIMD_TARGET_END SIMD_PRAGMA(clang attribute pop)
+#elif defined(__GNUC__)
+#define SIMD_TARGET_BEGIN(isa) SIMD_PRAGMA(GCC push_options) SIMD_PRAGMA(GCC target(isa))
+#define SIMD_TARGET_END SIMD_PRAGMA(GCC pop_options)
+#else
+// MSVC exposes every intrinsic without target options
+#define SIMD_TARGET_BEGIN(isa)
+#define SIMD_TARGET_END
+#endif
+
+struct SimdScalar {
+    typedef float F;
+    typedef bool Mask;
+    static const size_t WIDTH = 1;
+
+    static F load(const float* p) { return *p; }
+    static F loadu(const float* p) { return *p; }
+    static void store(float* p, F v) { *p = v; }
+    static void storeu(float* p, F v) { *p = v; }
+    static F set1(float v) { return v; }
+    static F add(F a, F b) { return a + b; }
+    static F sub(F a, F b) { return a - b; }
+    static F mul(F a, F b) { return a * b; }
+    static F div(F a, F b) { return a / b; }
+    static F fmadd(F a, F b, F c) { return a * b + c; }  // a * b + c
+    static F fnmadd(F a, F b, F c) { return c - a * b; } // c - a * b
+    static F sqrt(F a) { return std::sqrt(a); }
+    static F min(F a, F b) { return a < b ? a : b; }
+    static F max(F a, F b) { return a > b ? a : b; }
+    static F abs(F a) { return std::fabs(a); }
+    static Mask greater(F a, F b) { return a > b; }
+    static F select(Mask m, F ifTrue, F ifFalse) { return m ? ifTrue : ifFalse; }
+};
+
+#ifdef SIMD_X86
+SIMD_TARGET_BEGIN("sse2")
+struct SimdSse2 {
+    typedef __m128 F;
+    typedef __m128 Mask;
+    static const size_t WIDTH = 4;
+
+    static F load(const float* p) { return _mm_load_ps(p); }
+    static F loadu(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, F v) { _mm_store_ps(p, v); }
+    static void storeu(float* p, F v) { _mm_storeu_ps(p, v); }
+    static F set1(float v) { return _mm_set1_ps(v); }
+    static F add(F a, F b) { return _mm_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm_div_ps(a, b); }
+    static F fmadd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static F fnmadd(F a, F b, F c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+    static F sqrt(F a) { return _mm_sqrt_ps(a); }
+    static F min(F a, F b) { return _mm_min_ps(a, b); }
+    static F max(F a, F b) { return _mm_max_ps(a, b); }
+    static F abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static Mask greater(F a, F b) { return _mm_cmpgt_ps(a, b); }
+    static F select(Mask m, F ifTrue, F ifFalse) { return _mm_or_ps(_mm_and_ps(m, ifTrue), _mm_andnot_ps(m, ifFalse)); }
+};
+SIMD_TARGET_END
+
+SIMD_TARGET_BEGIN("avx2,fma")
+struct SimdAvx2 {
+    typedef __m256 F;
+    typedef __m256 Mask;
+    static const size_t WIDTH = 8;
+
+    static F load(const float* p) { return _mm256_load_ps(p); }
+    static F loadu(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, F v) { _mm256_store_ps(p, v); }
+    static void storeu(float* p, F v) { _mm256_storeu_ps(p, v); }
+    static F set1(float v) { return _mm256_set1_ps(v); }
+    static F add(F a, F b) { return _mm256_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm256_div_ps(a, b); }
+    static F fmadd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+    static F fnmadd(F a, F b, F c) { return _mm256_fnmadd_ps(a, b, c); }
+    static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+    static F min(F a, F b) { return _mm256_min_ps(a, b); }
+    static F max(F a, F b) { return _mm256_max_ps(a, b); }
+    static F abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static Mask greater(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static F select(Mask m, F ifTrue, F ifFalse) { return _mm256_blendv_ps(ifFalse, ifTrue, m); }
+};
+SIMD_TARGET_END
+
+SIMD_TARGET_BEGIN("avx512f,avx2,fma")
+struct SimdAvx512 {
+    typedef __m512 F;
+    typedef __mmask16 Mask;
+    static const size_t WIDTH = 16;
+
+    static F load(const float* p) { return _mm512_load_ps(p); }
+    static F loadu(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, F v) { _mm512_store_ps(p, v); }
+    static void storeu(float* p, F v) { _mm512_storeu_ps(p, v); }
+    static F set1(float v) { return _mm512_set1_ps(v); }
+    static F add(F a, F b) { return _mm512_add_ps(a, b); }
+    static F sub(F a, F b) { return _mm512_sub_ps(a, b); }
+    static F mul(F a, F b) { return _mm512_mul_ps(a, b); }
+    static F div(F a, F b) { return _mm512_div_ps(a, b); }
+    static F fmadd(F a, F b, F c) { return _mm512_fmadd_ps(a, b, c); }
+    static F fnmadd(F a, F b, F c) { return _mm512_fnmadd_ps(a, b, c); }
+    static F sqrt(F a) { return _mm512_sqrt_ps(a); }
+    static F min(F a, F b) { return _mm512_min_ps(a, b); }
+    static F max(F a, F b) { return _mm512_max_ps(a, b); }
+    static F abs(F a) { return _mm512_abs_ps(a); }
+    static Mask greater(F a, F b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static F select(Mask m, F ifTrue, F ifFalse) { return _mm512_mask_blend_ps(m, ifFalse, ifTrue); }
+};
+SIMD_TARGET_END
+#endif
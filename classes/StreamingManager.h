@@ -0,0 +1,257 @@
+#pragma once
+#include "Camera.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+
+// Memory cost of keeping a resource resident at one detail level. Level 0 is
+// the most detailed (full mip chain / LOD0); higher levels are coarser.
+struct StreamLevel {
+    size_t cpuBytes = 0;
+    size_t gpuBytes = 0;
+};
+
+// GPU cost of each mip level a texture can be streamed at: level n is the
+// image halved n times, with its own mip chain (a third more). Decoded
+// pixels are freed after upload, so nothing stays on the CPU side.
+inline std::vector<StreamLevel> textureStreamLevels(int width, int height, int channels, int levelCount) {
+    std::vector<StreamLevel> levels;
+    for (int level = 0; level < levelCount; ++level) {
+        StreamLevel l;
+        l.gpuBytes = size_t(width) * height * channels * 4 / 3;
+        levels.push_back(l);
+        if (width == 1 && height == 1) break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return levels;
+}
+
+// How the owner of a resource is asked to change its residency. request is
+// asynchronous: the owner passes the ticket back to StreamingManager::onLoaded
+// when the level is uploaded (e.g. from an AsyncAssetLoader callback), and
+// discards the data if onLoaded rejects it. release is synchronous and drops
+// the resource to the given coarser level, or unloads it at -1.
+struct StreamCallbacks {
+    std::function<void(int level, uint32_t ticket)> request;
+    std::function<void(int level)> release;
+};
+
+// Distance-driven residency for textures and meshes under CPU/GPU budgets.
+// Each update() picks a detail level per resource from its distance to the
+// camera, frees detail that is no longer needed, and requests upgrades
+// nearest-first. When an upgrade would exceed a budget the least recently
+// visible resources are evicted first.
+class StreamingManager {
+public:
+    typedef uint32_t Handle;
+    static const int NOT_RESIDENT = -1;
+
+    size_t cpuBudget;
+    size_t gpuBudget;
+    float lodDistance = 4.0f;      // distance, in radii, at which level 0 stops being needed
+    float unloadDistance = 200.0f; // beyond this a resource is evicted outright
+    size_t maxRequestsPerUpdate = 8;
+
+    StreamingManager(size_t cpuBudgetBytes, size_t gpuBudgetBytes)
+        : cpuBudget(cpuBudgetBytes), gpuBudget(gpuBudgetBytes) {}
+
+    Handle add(const glm::vec3& position, float radius, const std::vector<StreamLevel>& levels,
+               const StreamCallbacks& callbacks = StreamCallbacks()) {
+        Resource r;
+        r.position = position;
+        r.radius = std::max(radius, 1e-3f);
+        r.levels = levels;
+        r.callbacks = callbacks;
+        resources.push_back(r);
+        Handle h = static_cast<Handle>(resources.size() - 1);
+        resources[h].lru = lru.insert(lru.end(), h);
+        return h;
+    }
+
+    // Resident level already loaded by the caller (e.g. a low-res placeholder).
+    void setResident(Handle h, int level) {
+        Resource& r = resources[h];
+        account(r, r.resident, -1);
+        r.resident = level;
+        account(r, level, +1);
+    }
+
+    // For callbacks that need the handle add() returned.
+    void setCallbacks(Handle h, const StreamCallbacks& callbacks) { resources[h].callbacks = callbacks; }
+
+    void setPosition(Handle h, const glm::vec3& position) { resources[h].position = position; }
+
+    // Call for resources that passed culling this frame; drives LRU order.
+    void markVisible(Handle h) {
+        Resource& r = resources[h];
+        r.lastVisibleFrame = frame;
+        lru.splice(lru.begin(), lru, r.lru);
+    }
+
+    // level is what actually became resident (NOT_RESIDENT if the load
+    // failed). Returns false for a request that was cancelled since, whose
+    // data the owner should discard.
+    bool onLoaded(Handle h, uint32_t ticket, int level) {
+        Resource& r = resources[h];
+        if (r.pending == NOT_RESIDENT || ticket != r.ticket) return false;
+        unreserve(r);
+        account(r, r.resident, -1);
+        r.resident = level;
+        account(r, level, +1);
+        r.pending = NOT_RESIDENT;
+        return true;
+    }
+
+    void update(const OrbitCamera& camera) { update(camera.getPosition()); }
+
+    void update(const glm::vec3& cameraPosition) {
+        ++frame;
+        candidates.clear();
+
+        for (Handle h = 0; h < resources.size(); ++h) {
+            Resource& r = resources[h];
+            r.wanted = desiredLevel(r, cameraPosition);
+
+            // coarser than what is resident: release the detail right away
+            if (r.resident != NOT_RESIDENT && (r.wanted == NOT_RESIDENT || r.wanted > r.resident))
+                dropTo(r, r.wanted);
+            // coarser than what is in flight: cancel it and free its reservation
+            if (r.pending != NOT_RESIDENT && (r.wanted == NOT_RESIDENT || r.wanted > r.pending)) {
+                unreserve(r);
+                r.pending = NOT_RESIDENT;
+            }
+
+            if (r.wanted != NOT_RESIDENT && r.pending == NOT_RESIDENT &&
+                (r.resident == NOT_RESIDENT || r.wanted < r.resident))
+                candidates.push_back(h);
+        }
+
+        // recently visible first, then the ones whose detail matters most
+        std::sort(candidates.begin(), candidates.end(), [this](Handle a, Handle b) {
+            const Resource& ra = resources[a];
+            const Resource& rb = resources[b];
+            if (ra.lastVisibleFrame != rb.lastVisibleFrame) return ra.lastVisibleFrame > rb.lastVisibleFrame;
+            return ra.priority > rb.priority;
+        });
+
+        size_t issued = 0;
+        for (Handle h : candidates) {
+            if (issued >= maxRequestsPerUpdate) break;
+            Resource& r = resources[h];
+            StreamLevel need = r.levels[r.wanted];
+            StreamLevel have = r.resident == NOT_RESIDENT ? StreamLevel() : r.levels[r.resident];
+            size_t extraCpu = need.cpuBytes > have.cpuBytes ? need.cpuBytes - have.cpuBytes : 0;
+            size_t extraGpu = need.gpuBytes > have.gpuBytes ? need.gpuBytes - have.gpuBytes : 0;
+
+            if (!makeRoom(extraCpu, extraGpu, h)) continue;
+            r.pending = r.wanted;
+            ++r.ticket;
+            r.reservedCpu = extraCpu;
+            r.reservedGpu = extraGpu;
+            reservedCpu += extraCpu;
+            reservedGpu += extraGpu;
+            ++issued;
+            if (r.callbacks.request) r.callbacks.request(r.wanted, r.ticket);
+        }
+    }
+
+    int residentLevel(Handle h) const { return resources[h].resident; }
+    size_t cpuUsage() const { return usedCpu; }
+    size_t gpuUsage() const { return usedGpu; }
+    size_t resourceCount() const { return resources.size(); }
+
+private:
+    struct Resource {
+        glm::vec3 position;
+        float radius = 1.0f;
+        std::vector<StreamLevel> levels;
+        StreamCallbacks callbacks;
+        int resident = NOT_RESIDENT;
+        int pending = NOT_RESIDENT;
+        int wanted = NOT_RESIDENT;
+        uint32_t ticket = 0;       // of the latest request; older ones are stale
+        float priority = 0.0f;
+        size_t reservedCpu = 0, reservedGpu = 0;
+        uint64_t lastVisibleFrame = 0;
+        std::list<Handle>::iterator lru;
+    };
+
+    std::vector<Resource> resources;
+    std::list<Handle> lru; // front = most recently visible
+    std::vector<Handle> candidates;
+    std::vector<Handle> victims; // makeRoom() scratch
+    uint64_t frame = 0;
+    size_t usedCpu = 0, usedGpu = 0;
+    size_t reservedCpu = 0, reservedGpu = 0;
+
+    // Each doubling of distance beyond lodDistance radii drops one level.
+    int desiredLevel(Resource& r, const glm::vec3& cameraPosition) {
+        float distance = std::max(glm::length(r.position - cameraPosition) - r.radius, 0.0f);
+        r.priority = r.radius / (distance + r.radius);
+        if (distance > unloadDistance || r.levels.empty()) return NOT_RESIDENT;
+        float ratio = distance / (r.radius * lodDistance);
+        int level = ratio <= 1.0f ? 0 : static_cast<int>(std::floor(std::log2(ratio))) + 1;
+        return std::min(level, static_cast<int>(r.levels.size()) - 1);
+    }
+
+    void account(const Resource& r, int level, int sign) {
+        if (level == NOT_RESIDENT) return;
+        const StreamLevel& l = r.levels[level];
+        if (sign > 0) { usedCpu += l.cpuBytes; usedGpu += l.gpuBytes; }
+        else { usedCpu -= std::min(usedCpu, l.cpuBytes); usedGpu -= std::min(usedGpu, l.gpuBytes); }
+    }
+
+    void unreserve(Resource& r) {
+        reservedCpu -= r.reservedCpu;
+        reservedGpu -= r.reservedGpu;
+        r.reservedCpu = r.reservedGpu = 0;
+    }
+
+    void dropTo(Resource& r, int level) {
+        account(r, r.resident, -1);
+        r.resident = level;
+        account(r, level, +1);
+        if (r.callbacks.release) r.callbacks.release(level);
+    }
+
+    bool fits(size_t cpu, size_t gpu) const {
+        return usedCpu + reservedCpu + cpu <= cpuBudget && usedGpu + reservedGpu + gpu <= gpuBudget;
+    }
+
+    // Evicts from the LRU tail until the request fits. Only resources seen
+    // less recently than the requester, or equally recently but with lower
+    // priority, are eligible, so near visible objects are never pushed out
+    // by far ones. Victims are chosen first and evicted only if together
+    // they make enough room; otherwise nothing is dropped.
+    bool makeRoom(size_t cpu, size_t gpu, Handle requester) {
+        if (fits(cpu, gpu)) return true;
+        const Resource& req = resources[requester];
+        victims.clear();
+        size_t freedCpu = 0, freedGpu = 0;
+        bool enough = false;
+        for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
+            Handle victim = *it;
+            const Resource& v = resources[victim];
+            if (v.lastVisibleFrame > req.lastVisibleFrame) break; // the rest are more recent
+            if (victim == requester || v.resident == NOT_RESIDENT || v.pending != NOT_RESIDENT) continue;
+            if (v.lastVisibleFrame == req.lastVisibleFrame && v.priority >= req.priority) continue;
+            victims.push_back(victim);
+            freedCpu += v.levels[v.resident].cpuBytes;
+            freedGpu += v.levels[v.resident].gpuBytes;
+            if (usedCpu - std::min(usedCpu, freedCpu) + reservedCpu + cpu <= cpuBudget &&
+                usedGpu - std::min(usedGpu, freedGpu) + reservedGpu + gpu <= gpuBudget) {
+                enough = true;
+                break;
+            }
+        }
+        if (!enough) return false;
+        for (Handle victim : victims) dropTo(resources[victim], NOT_RESIDENT);
+        return fits(cpu, gpu);
+    }
+};
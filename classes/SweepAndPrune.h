@@ -0,0 +1,158 @@
+#pragma once
+#include "Broadphase.h"
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+// Incremental sweep and prune. Each axis keeps a sorted list of interval
+// endpoints that persists between steps; a moved proxy's endpoints are
+// walked to their new place by insertion sort, and every endpoint they pass
+// is a potential pair change: a min passing a max going down (or a max
+// passing a min going up) may start an overlap, the reverse ends one. With
+// temporal coherence endpoints move a few places per step, so the cost is
+// proportional to how many proxies move and how far, and resting proxies
+// cost nothing.
+//
+// Weak spots: large fast movers pass many endpoints, and clustering along
+// one axis makes every move long. The tree broadphase suits those scenes.
+class SweepAndPrune : public Broadphase {
+public:
+    const char* name() const override { return "sap"; }
+
+    uint32_t addProxy(const Aabb& box, uint32_t userData) override {
+        uint32_t id;
+        if (!freeProxies.empty()) {
+            id = freeProxies.back();
+            freeProxies.pop_back();
+        } else {
+            id = uint32_t(proxies.size());
+            proxies.push_back(Proxy());
+        }
+        Proxy& proxy = proxies[id];
+        proxy.box = box;
+        proxy.userData = userData;
+        proxy.alive = true;
+
+        // append both endpoints and sort them down into place; only the last
+        // axis reports overlaps, when the other two are already in order
+        for (int axis = 0; axis < 3; ++axis) {
+            std::vector<Endpoint>& list = endpoints[axis];
+            Endpoint lo = { box.min[axis], id << 1 };
+            Endpoint hi = { box.max[axis], (id << 1) | 1u };
+            list.push_back(lo);
+            list.push_back(hi);
+            proxy.minIndex[axis] = uint32_t(list.size() - 2);
+            proxy.maxIndex[axis] = uint32_t(list.size() - 1);
+            sortDown(axis, proxy.minIndex[axis], axis == 2);
+            sortDown(axis, proxies[id].maxIndex[axis], axis == 2);
+        }
+        return id;
+    }
+
+    void moveProxy(uint32_t id, const Aabb& box) override {
+        Proxy& proxy = proxies[id];
+        if (box.min == proxy.box.min && box.max == proxy.box.max) return;
+        Aabb old = proxy.box;
+        proxy.box = box;
+        for (int axis = 0; axis < 3; ++axis) {
+            uint32_t lo = proxy.minIndex[axis], hi = proxy.maxIndex[axis];
+            endpoints[axis][lo].value = box.min[axis];
+            endpoints[axis][hi].value = box.max[axis];
+            // grow before shrinking so a proxy's endpoints never cross each other
+            if (box.min[axis] < old.min[axis]) sortDown(axis, proxies[id].minIndex[axis], true);
+            if (box.max[axis] > old.max[axis]) sortUp(axis, proxies[id].maxIndex[axis], true);
+            if (box.min[axis] > old.min[axis]) sortUp(axis, proxies[id].minIndex[axis], true);
+            if (box.max[axis] < old.max[axis]) sortDown(axis, proxies[id].maxIndex[axis], true);
+        }
+    }
+
+    void removeProxy(uint32_t id) override {
+        Proxy& proxy = proxies[id];
+        cache.removeAll(proxy.userData);
+        // push both endpoints past everything else, then drop them
+        for (int axis = 0; axis < 3; ++axis) {
+            endpoints[axis][proxy.maxIndex[axis]].value = FLT_MAX;
+            sortUp(axis, proxy.maxIndex[axis], false);
+            endpoints[axis][proxy.minIndex[axis]].value = FLT_MAX;
+            sortUp(axis, proxy.minIndex[axis], false);
+            endpoints[axis].pop_back();
+            endpoints[axis].pop_back();
+        }
+        proxy.alive = false;
+        freeProxies.push_back(id);
+    }
+
+    // Endpoint swaps since the last call: the broadphase's actual work.
+    size_t takeSwapCount() {
+        size_t n = swaps;
+        swaps = 0;
+        return n;
+    }
+
+private:
+    struct Endpoint {
+        float value;
+        uint32_t data; // proxy << 1 | isMax
+    };
+
+    struct Proxy {
+        Aabb box;
+        uint32_t minIndex[3] = {}, maxIndex[3] = {};
+        uint32_t userData = 0;
+        bool alive = false;
+    };
+
+    std::vector<Endpoint> endpoints[3];
+    std::vector<Proxy> proxies;
+    std::vector<uint32_t> freeProxies;
+    size_t swaps = 0;
+
+    static uint32_t proxyOf(const Endpoint& e) { return e.data >> 1; }
+    static bool isMax(const Endpoint& e) { return (e.data & 1u) != 0; }
+
+    void setIndex(int axis, uint32_t position) {
+        const Endpoint& e = endpoints[axis][position];
+        Proxy& proxy = proxies[proxyOf(e)];
+        if (isMax(e)) proxy.maxIndex[axis] = position;
+        else proxy.minIndex[axis] = position;
+    }
+
+    // Passing endpoint `other` changes the pair only between a min and a max
+    // of different proxies; `opening` is true when the pass can start an
+    // overlap, false when it ends one.
+    void passed(const Endpoint& moving, const Endpoint& other, bool opening) {
+        uint32_t a = proxyOf(moving), b = proxyOf(other);
+        if (a == b || isMax(moving) == isMax(other)) return;
+        if (opening) {
+            if (aabbOverlap(proxies[a].box, proxies[b].box)) cache.add(proxies[a].userData, proxies[b].userData);
+        } else {
+            cache.remove(proxies[a].userData, proxies[b].userData);
+        }
+    }
+
+    void sortDown(int axis, uint32_t position, bool updatePairs) {
+        std::vector<Endpoint>& list = endpoints[axis];
+        while (position > 0 && list[position - 1].value > list[position].value) {
+            // going down, a min passing a max may open; a max passing a min closes
+            if (updatePairs) passed(list[position], list[position - 1], !isMax(list[position]));
+            std::swap(list[position], list[position - 1]);
+            setIndex(axis, position);
+            setIndex(axis, position - 1);
+            --position;
+            ++swaps;
+        }
+    }
+
+    void sortUp(int axis, uint32_t position, bool updatePairs) {
+        std::vector<Endpoint>& list = endpoints[axis];
+        while (position + 1 < list.size() && list[position + 1].value < list[position].value) {
+            if (updatePairs) passed(list[position], list[position + 1], isMax(list[position]));
+            std::swap(list[position], list[position + 1]);
+            setIndex(axis, position);
+            setIndex(axis, position + 1);
+            ++position;
+            ++swaps;
+        }
+    }
+};
@@ -0,0 +1,413 @@
+#pragma once
+#include "Broadphase.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Uniform grid rebuilt from scratch every step, for many small bodies of
+// similar size (debris, particles). Each proxy lives in the one cell that
+// holds its centre; as long as a proxy is no wider than a cell, anything it
+// overlaps sits in the same or an adjacent cell. Every stage is a flat data
+// parallel pass over the worker threads:
+//
+//   1. cell key per proxy: Morton code of its cell (10 bits per axis,
+//      wrapping), so sorted order is also spatially local
+//   2. LSD radix sort of the keys, three 10-bit digits; each pass counts
+//      per thread, scans the counts, then scatters per thread
+//   3. run starts in the sorted keys, marked per chunk and compacted
+//      through a scan into the list of occupied cells, which is then hashed
+//      into an open addressing table with one compare-and-swap per cell
+//   4. each occupied cell tests itself and its 13 "forward" neighbours (the
+//      other 13 are covered from the other side) into per-thread buckets,
+//      one per pair hash shard, so no locks are taken
+//   5. each shard sorts its pairs and merges them with the shard's pairs
+//      from the previous step, giving the added and removed pairs; the
+//      shards are then copied side by side into the pair list
+//
+// Proxies wider than a cell are tested against everything instead; keep
+// cellSize at about the diameter of the typical proxy.
+class UniformGridBroadphase : public Broadphase {
+public:
+    float cellSize = 1.0f;
+
+    explicit UniformGridBroadphase(unsigned int threadCount = 0) : pool(threadCount) {}
+
+    const char* name() const override { return "grid"; }
+
+    uint32_t addProxy(const Aabb& box, uint32_t userData) override {
+        uint32_t id;
+        if (!freeProxies.empty()) {
+            id = freeProxies.back();
+            freeProxies.pop_back();
+        } else {
+            id = uint32_t(proxyToDense.size());
+            proxyToDense.push_back(0);
+        }
+        proxyToDense[id] = uint32_t(boxes.size());
+        boxes.push_back(box);
+        users.push_back(userData);
+        denseToProxy.push_back(id);
+        return id;
+    }
+
+    void moveProxy(uint32_t id, const Aabb& box) override { boxes[proxyToDense[id]] = box; }
+
+    void removeProxy(uint32_t id) override {
+        uint32_t index = proxyToDense[id];
+        uint32_t user = users[index];
+        cache.removeAll(user);
+        // so the next diff neither reports these again nor confuses them
+        // with pairs of a proxy that reuses the value
+        for (std::vector<uint64_t>& shard : previousPairs)
+            shard.erase(std::remove_if(shard.begin(), shard.end(), [user](uint64_t k) {
+                return uint32_t(k >> 32) == user || uint32_t(k) == user;
+            }), shard.end());
+        uint32_t last = uint32_t(boxes.size() - 1);
+        boxes[index] = boxes[last];
+        users[index] = users[last];
+        denseToProxy[index] = denseToProxy[last];
+        proxyToDense[denseToProxy[index]] = index;
+        boxes.pop_back();
+        users.pop_back();
+        denseToProxy.pop_back();
+        freeProxies.push_back(id);
+    }
+
+    void updatePairs() override {
+        size_t n = boxes.size();
+        unsigned int threads = pool.size();
+        shards = threads;
+        keys.resize(n);
+        order.resize(n);
+        sortedKeys.resize(n);
+        sortedOrder.resize(n);
+        oversize.resize(n);
+        threadOversize.resize(threads);
+        for (unsigned int t = 0; t < threads; ++t) threadOversize[t].clear();
+        buckets.resize(size_t(threads) * shards);
+        for (std::vector<uint64_t>& bucket : buckets) bucket.clear();
+        previousPairs.resize(shards);
+        shardPairs.resize(shards);
+        shardAdded.resize(shards);
+        shardRemoved.resize(shards);
+
+        // 1. keys
+        const float invCell = 1.0f / cellSize;
+        parallelFor(n, [&](size_t begin, size_t end, unsigned int t) {
+            for (size_t i = begin; i < end; ++i) {
+                const Aabb& box = boxes[i];
+                glm::vec3 size = box.max - box.min;
+                oversize[i] = size.x > cellSize || size.y > cellSize || size.z > cellSize;
+                if (oversize[i]) threadOversize[t].push_back(uint32_t(i));
+                glm::vec3 centre = (box.min + box.max) * (0.5f * invCell);
+                keys[i] = cellKey(int(std::floor(centre.x)), int(std::floor(centre.y)), int(std::floor(centre.z)));
+                order[i] = uint32_t(i);
+            }
+        });
+
+        // 2. sort (ends in sortedKeys/sortedOrder after an odd number of passes)
+        radixSort(n, threads);
+
+        // gather boxes into sorted order so the pair pass reads them linearly
+        sortedBoxes.resize(n);
+        parallelFor(n, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t s = begin; s < end; ++s) sortedBoxes[s] = boxes[sortedOrder[s]];
+        });
+
+        // 3. occupied cells
+        findCells(n, threads);
+        buildCellTable();
+
+        // 4. pairs, one cell at a time: the 13 neighbour lookups are shared
+        // by everything in the cell
+        size_t cells = cellKeys.size();
+        parallelFor(cells, [&](size_t begin, size_t end, unsigned int t) {
+            std::vector<uint64_t>* out = &buckets[size_t(t) * shards];
+            for (size_t c = begin; c < end; ++c) {
+                size_t runBegin = cellStart[c], runEnd = cellStart[c + 1];
+                for (size_t a = runBegin; a < runEnd; ++a)
+                    for (size_t b = a + 1; b < runEnd; ++b) test(a, b, out);
+
+                int cx, cy, cz;
+                cellOf(cellKeys[c], cx, cy, cz);
+                for (int k = 0; k < 13; ++k) {
+                    size_t neighbour = findCell(cellKey(cx + FORWARD[k][0], cy + FORWARD[k][1], cz + FORWARD[k][2]));
+                    if (neighbour == SIZE_MAX) continue;
+                    for (size_t b = cellStart[neighbour]; b < cellStart[neighbour + 1]; ++b)
+                        for (size_t a = runBegin; a < runEnd; ++a) test(a, b, out);
+                }
+            }
+        });
+
+        // oversize proxies against everything
+        big.clear();
+        for (unsigned int t = 0; t < threads; ++t) big.insert(big.end(), threadOversize[t].begin(), threadOversize[t].end());
+        if (!big.empty()) {
+            parallelFor(n, [&](size_t begin, size_t end, unsigned int t) {
+                std::vector<uint64_t>* out = &buckets[size_t(t) * shards];
+                for (size_t j = begin; j < end; ++j)
+                    for (uint32_t i : big)
+                        if (i != j && (!oversize[j] || i < j) && aabbOverlap(boxes[i], boxes[j]))
+                            emit(out, users[i], users[j]);
+            });
+        }
+
+        // 5. diff every shard against the previous step, then lay the shards
+        // out side by side
+        parallelFor(shards, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t s = begin; s < end; ++s) diffShard(s, threads);
+        });
+        shardOffset.assign(shards + 1, 0);
+        added.clear();
+        removed.clear();
+        for (unsigned int s = 0; s < shards; ++s) {
+            shardOffset[s + 1] = shardOffset[s] + previousPairs[s].size();
+            added.insert(added.end(), shardAdded[s].begin(), shardAdded[s].end());
+            removed.insert(removed.end(), shardRemoved[s].begin(), shardRemoved[s].end());
+        }
+        current.resize(shardOffset[shards]);
+        parallelFor(shards, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t s = begin; s < end; ++s) {
+                OverlapPair* at = current.data() + shardOffset[s];
+                for (uint64_t k : previousPairs[s]) *at++ = pairOfKey(k);
+            }
+        });
+        cache.replace(current, added, removed);
+    }
+
+private:
+    static constexpr int RADIX_BITS = 10;
+    static constexpr uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+    static constexpr int KEY_BITS = 30;
+    static constexpr uint64_t EMPTY_CELL = UINT64_MAX; // keys use 30 bits
+    // half of the 26 neighbours: z ahead, or same z and y ahead, or same row and x ahead
+    static constexpr int FORWARD[13][3] = {
+        { 1, 0, 0 },
+        { -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+        { -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 },
+        { -1, 0, 1 }, { 0, 0, 1 }, { 1, 0, 1 },
+        { -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 },
+    };
+
+    ThreadPool pool;
+    std::vector<Aabb> boxes;            // dense, live proxies only
+    std::vector<uint32_t> users;
+    std::vector<uint32_t> denseToProxy;
+    std::vector<uint32_t> proxyToDense;
+    std::vector<uint32_t> freeProxies;
+
+    std::vector<uint32_t> keys, order, sortedKeys, sortedOrder;
+    std::vector<Aabb> sortedBoxes;
+    std::vector<unsigned char> oversize;
+    std::vector<uint32_t> histogram;    // [thread][digit]
+    std::vector<uint32_t> cellKeys;     // occupied cells, sorted
+    std::vector<uint32_t> cellStart;    // first sorted index per cell, plus n
+    std::vector<size_t> chunkCells;     // cells found per chunk, then scanned
+    std::unique_ptr<std::atomic<uint64_t>[]> cellTable; // key << 32 | cell index
+    size_t cellTableSize = 0;
+    uint32_t cellMask = 0;
+    std::vector<std::vector<uint32_t>> threadOversize;
+    std::vector<uint32_t> big;
+
+    // pairs as (a << 32 | b) keys, a < b, split into shards by hash
+    unsigned int shards = 1;
+    std::vector<std::vector<uint64_t>> buckets;       // [thread][shard], this step
+    std::vector<std::vector<uint64_t>> previousPairs; // [shard], sorted
+    std::vector<std::vector<uint64_t>> shardPairs;    // [shard] scratch
+    std::vector<std::vector<OverlapPair>> shardAdded, shardRemoved;
+    std::vector<size_t> shardOffset;
+    std::vector<OverlapPair> current, added, removed;
+
+    static OverlapPair pairOfKey(uint64_t k) {
+        OverlapPair p;
+        p.a = uint32_t(k >> 32);
+        p.b = uint32_t(k);
+        return p;
+    }
+
+    void emit(std::vector<uint64_t>* out, uint32_t userA, uint32_t userB) const {
+        uint64_t k = userA < userB ? (uint64_t(userA) << 32) | userB : (uint64_t(userB) << 32) | userA;
+        out[((k * 0x9E3779B97F4A7C15ull) >> 32) % shards].push_back(k);
+    }
+
+    // a and b are sorted positions
+    void test(size_t a, size_t b, std::vector<uint64_t>* out) const {
+        uint32_t i = sortedOrder[a], j = sortedOrder[b];
+        if (!oversize[i] && !oversize[j] && aabbOverlap(sortedBoxes[a], sortedBoxes[b])) emit(out, users[i], users[j]);
+    }
+
+    // Gathers the shard's pairs from every thread, sorts them and walks them
+    // against last step's sorted list; the new list replaces the old one.
+    void diffShard(size_t s, unsigned int threads) {
+        std::vector<uint64_t>& now = shardPairs[s];
+        now.clear();
+        for (unsigned int t = 0; t < threads; ++t) {
+            const std::vector<uint64_t>& bucket = buckets[size_t(t) * shards + s];
+            now.insert(now.end(), bucket.begin(), bucket.end());
+        }
+        std::sort(now.begin(), now.end());
+        now.erase(std::unique(now.begin(), now.end()), now.end()); // wrapped cells can meet twice
+
+        const std::vector<uint64_t>& before = previousPairs[s];
+        shardAdded[s].clear();
+        shardRemoved[s].clear();
+        size_t i = 0, j = 0;
+        while (i < now.size() || j < before.size()) {
+            if (j == before.size() || (i < now.size() && now[i] < before[j])) shardAdded[s].push_back(pairOfKey(now[i++]));
+            else if (i == now.size() || before[j] < now[i]) shardRemoved[s].push_back(pairOfKey(before[j++]));
+            else { ++i; ++j; }
+        }
+        previousPairs[s].swap(now);
+    }
+
+    static uint32_t spread(uint32_t v) {
+        v &= 0x3ff;
+        v = (v | (v << 16)) & 0x030000ff;
+        v = (v | (v << 8)) & 0x0300f00f;
+        v = (v | (v << 4)) & 0x030c30c3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    static uint32_t compact(uint32_t v) {
+        v &= 0x09249249;
+        v = (v | (v >> 2)) & 0x030c30c3;
+        v = (v | (v >> 4)) & 0x0300f00f;
+        v = (v | (v >> 8)) & 0x030000ff;
+        v = (v | (v >> 16)) & 0x3ff;
+        return v;
+    }
+
+    // Coordinates wrap at 1024 cells; far cells that alias only add
+    // candidates that fail the box test.
+    static uint32_t cellKey(int x, int y, int z) {
+        return spread(uint32_t(x)) | (spread(uint32_t(y)) << 1) | (spread(uint32_t(z)) << 2);
+    }
+
+    static void cellOf(uint32_t key, int& x, int& y, int& z) {
+        x = int(compact(key));
+        y = int(compact(key >> 1));
+        z = int(compact(key >> 2));
+    }
+
+    // Marks where each run of equal sorted keys starts, per chunk, then
+    // scans the per-chunk counts so every chunk writes its cells to its own
+    // range of cellKeys/cellStart.
+    void findCells(size_t n, unsigned int threads) {
+        chunkCells.assign(threads + 1, 0);
+        parallelFor(n, [&](size_t begin, size_t end, unsigned int t) {
+            size_t count = 0;
+            for (size_t s = begin; s < end; ++s) count += s == 0 || sortedKeys[s] != sortedKeys[s - 1];
+            chunkCells[t + 1] = count;
+        });
+        for (unsigned int t = 0; t < threads; ++t) chunkCells[t + 1] += chunkCells[t];
+        size_t cells = chunkCells[threads];
+        cellKeys.resize(cells);
+        cellStart.resize(cells + 1);
+        parallelFor(n, [&](size_t begin, size_t end, unsigned int t) {
+            size_t at = chunkCells[t];
+            for (size_t s = begin; s < end; ++s) {
+                if (s > 0 && sortedKeys[s] == sortedKeys[s - 1]) continue;
+                cellKeys[at] = sortedKeys[s];
+                cellStart[at] = uint32_t(s);
+                ++at;
+            }
+        });
+        cellStart[cells] = uint32_t(n);
+    }
+
+    // Hash from occupied cell key to its index in cellKeys, so a neighbour
+    // lookup is one or two probes. Keys are unique, so each insert is one
+    // compare-and-swap into the first empty slot; pool.wait() publishes it.
+    void buildCellTable() {
+        size_t cells = cellKeys.size();
+        size_t capacity = 16;
+        while (capacity < cells * 2) capacity <<= 1;
+        if (capacity > cellTableSize) {
+            cellTable.reset(new std::atomic<uint64_t>[capacity]);
+            cellTableSize = capacity;
+        }
+        cellMask = uint32_t(capacity - 1);
+        parallelFor(capacity, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t i = begin; i < end; ++i) cellTable[i].store(EMPTY_CELL, std::memory_order_relaxed);
+        });
+        parallelFor(cells, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t c = begin; c < end; ++c) {
+                uint64_t entry = (uint64_t(cellKeys[c]) << 32) | c;
+                for (uint32_t slot = hashCell(cellKeys[c]);; slot = (slot + 1) & cellMask) {
+                    uint64_t expected = EMPTY_CELL;
+                    if (cellTable[slot].compare_exchange_strong(expected, entry, std::memory_order_relaxed)) break;
+                }
+            }
+        });
+    }
+
+    // Index of the cell in cellKeys, or SIZE_MAX when it is empty.
+    size_t findCell(uint32_t key) const {
+        for (uint32_t slot = hashCell(key);; slot = (slot + 1) & cellMask) {
+            uint64_t entry = cellTable[slot].load(std::memory_order_relaxed);
+            if (entry == EMPTY_CELL) return SIZE_MAX;
+            if (uint32_t(entry >> 32) == key) return size_t(uint32_t(entry));
+        }
+    }
+
+    uint32_t hashCell(uint32_t key) const { return (key * 2654435761u) & cellMask; }
+
+    // Splits [0, count) into one contiguous chunk per worker; fn(begin, end, thread).
+    template <typename Fn>
+    void parallelFor(size_t count, Fn fn) {
+        unsigned int threads = pool.size();
+        size_t chunk = (count + threads - 1) / threads;
+        for (unsigned int t = 0; t < threads; ++t) {
+            size_t begin = std::min(count, t * chunk), end = std::min(count, begin + chunk);
+            pool.submit([&fn, begin, end, t] { fn(begin, end, t); });
+        }
+        pool.wait();
+    }
+
+    // Stable LSD radix sort of (keys, order) into (sortedKeys, sortedOrder).
+    // Every thread scatters its own chunk to offsets reserved for it by the
+    // scan, so the passes need no atomics.
+    void radixSort(size_t n, unsigned int threads) {
+        histogram.assign(size_t(threads) * RADIX_SIZE, 0);
+        uint32_t *srcKeys = keys.data(), *srcOrder = order.data();
+        uint32_t *dstKeys = sortedKeys.data(), *dstOrder = sortedOrder.data();
+        for (int shift = 0; shift < KEY_BITS; shift += RADIX_BITS) {
+            std::fill(histogram.begin(), histogram.end(), 0);
+            parallelFor(n, [&](size_t begin, size_t end, unsigned int t) {
+                uint32_t* counts = &histogram[size_t(t) * RADIX_SIZE];
+                for (size_t i = begin; i < end; ++i) ++counts[(srcKeys[i] >> shift) & (RADIX_SIZE - 1)];
+            });
+            // exclusive scan, digit-major then thread, keeps the sort stable
+            uint32_t running = 0;
+            for (uint32_t digit = 0; digit < RADIX_SIZE; ++digit) {
+                for (unsigned int t = 0; t < threads; ++t) {
+                    uint32_t& slot = histogram[size_t(t) * RADIX_SIZE + digit];
+                    uint32_t c = slot;
+                    slot = running;
+                    running += c;
+                }
+            }
+            parallelFor(n, [&](size_t begin, size_t end, unsigned int t) {
+                uint32_t* offsets = &histogram[size_t(t) * RADIX_SIZE];
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t at = offsets[(srcKeys[i] >> shift) & (RADIX_SIZE - 1)]++;
+                    dstKeys[at] = srcKeys[i];
+                    dstOrder[at] = srcOrder[i];
+                }
+            });
+            std::swap(srcKeys, dstKeys);
+            std::swap(srcOrder, dstOrder);
+        }
+        // three passes: the result is in the buffers that started as destination
+        if (srcKeys != sortedKeys.data()) {
+            std::copy(srcKeys, srcKeys + n, sortedKeys.begin());
+            std::copy(srcOrder, srcOrder + n, sortedOrder.begin());
+        }
+    }
+};
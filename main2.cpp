@@ -6,6 +6,7 @@
 #include <iostream>
 #include <vector>
 #include "stb_image.h"
+#include "classes/NormalMatrix.h"
 
 // -------------------- Shader Class --------------------
 class Shader {
@@ -38,6 +39,9 @@ public:
     void setMat4(const std::string &name, const glm::mat4 &mat) const {
         glUniformMatrix4fv(glGetUniformLocation(ID.c_str(), name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
     }
+    void setMat3(const std::string &name, const glm::mat3 &mat) const {
+        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    }
     void setVec3(const std::string &name, const glm::vec3 &value) const {
         glUniform3fv(glGetUniformLocation(ID.c_str(), name.c_str()), 1, &value[0]);
     }
@@ -180,9 +184,10 @@ int main() {
         out vec3 FragPos;
         out vec3 Normal;
         uniform mat4 model;
+        uniform mat3 normalMatrix; // inverse-transpose of model, from the CPU
         uniform mat4 view;
         uniform mat4 projection;
-        void main(){ FragPos = vec3(model*vec4(aPos,1.0)); Normal = mat3(transpose(inverse(model)))*aNormal; gl_Position = projection*view*vec4(aPos,1.0); }
+        void main(){ FragPos = vec3(model*vec4(aPos,1.0)); Normal = normalMatrix*aNormal; gl_Position = projection*view*vec4(aPos,1.0); }
     )GLSL";
 
     const char* fragmentShaderSource = R"GLSL(
@@ -242,6 +247,7 @@ int main() {
         // Draw cube
         shader.use();
         shader.setMat4("model", model);
+        shader.setMat3("normalMatrix", normalMatrix(model, TRANSFORM_RIGID)); // pure rotation
         shader.setMat4("view", view);
         shader.setMat4("projection", projection);
         shader.setVec3("objectColor", mat.Color);
@@ -0,0 +1,63 @@
+// Packs loose asset files into a .pak archive (see classes/PakArchive.h).
+//
+//   pak_builder out.pak [--align N] [--lz4 | --zstd] [--root DIR] files/dirs...
+//
+// Entry names are paths relative to --root (default: the working directory),
+// which is what the runtime passes to PakArchive::find, e.g. "container2.png".
+// Build with -DPAK_WITH_LZ4 -llz4 and/or -DPAK_WITH_ZSTD -lzstd to enable
+// compression.
+#include "classes/PakArchive.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "usage: " << argv[0] << " out.pak [--align N] [--lz4|--zstd] [--root DIR] files/dirs..." << std::endl;
+        return 1;
+    }
+
+    std::string output = argv[1];
+    uint32_t alignment = 16;
+    PakCompression compression = PAK_STORED;
+    fs::path root = fs::current_path();
+    std::vector<fs::path> inputs;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--align" && i + 1 < argc) alignment = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (arg == "--lz4") compression = PAK_LZ4;
+        else if (arg == "--zstd") compression = PAK_ZSTD;
+        else if (arg == "--root" && i + 1 < argc) root = argv[++i];
+        else inputs.push_back(arg);
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        std::cout << "alignment must be a power of two" << std::endl;
+        return 1;
+    }
+
+    std::vector<fs::path> files;
+    for (const fs::path& input : inputs) {
+        if (fs::is_directory(input)) {
+            for (const auto& entry : fs::recursive_directory_iterator(input))
+                if (entry.is_regular_file()) files.push_back(entry.path());
+        } else {
+            files.push_back(input);
+        }
+    }
+
+    PakWriter writer(alignment);
+    for (const fs::path& file : files) {
+        std::string name = fs::relative(fs::absolute(file), fs::absolute(root)).generic_string();
+        if (!writer.addFile(name, file.string(), compression)) return 1;
+    }
+    if (!writer.write(output)) return 1;
+
+    std::cout << "wrote " << files.size() << " entries to " << output << std::endl;
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Checks the SIMD integration kernels against the scalar reference.
+//
+//   physics_tests [seed]
+//
+// Random bodies, a quarter of them kinematic, are padded to PHYSICS_LANES
+// with inert bodies the way PhysicsWorld lays them out, copied, and stepped
+// with integrateBodiesScalar and with every simd_*::integrateBodies this CPU
+// runs. The wide kernels use FMA, so they must agree to rounding, not bit
+// for bit; padding lanes must stay inert. Exits non-zero on a mismatch.
+//
+// Build next to the demo, e.g.
+//   g++ -std=c++17 -O2 -Iinclude physics_tests.cpp -o physics_tests
+#include "classes/PhysicsWorld.h"
+#include "classes/SimdKernels.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int STREAMS = 23;
+static const int STEPS = 16;
+
+// One 64-byte aligned allocation per stream, like PhysicsWorld.
+struct TestBodies {
+    float* streams[STREAMS] = {};
+    BodyArrays arrays;
+
+    TestBodies(size_t count, size_t padded) {
+        for (float*& s : streams) {
+            s = static_cast<float*>(std::aligned_alloc(64, padded * sizeof(float)));
+            for (size_t i = 0; i < padded; ++i) s[i] = 0.0f;
+        }
+        float** s = streams;
+        arrays = BodyArrays{ s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[8], s[9], s[10], s[11],
+                             s[12], s[13], s[14], s[15], s[16], s[17], s[18], s[19], s[20], s[21], s[22],
+                             count, padded };
+        for (size_t i = 0; i < padded; ++i) arrays.qw[i] = 1.0f; // inert padding: identity orientation
+    }
+    ~TestBodies() { for (float* s : streams) std::free(s); }
+    TestBodies(const TestBodies&) = delete;
+    TestBodies& operator=(const TestBodies&) = delete;
+
+    void copyFrom(const TestBodies& other) {
+        for (int k = 0; k < STREAMS; ++k)
+            for (size_t i = 0; i < arrays.padded; ++i) streams[k][i] = other.streams[k][i];
+    }
+};
+
+static const char* streamNames[STREAMS] = {
+    "px", "py", "pz", "qx", "qy", "qz", "qw", "vx", "vy", "vz", "wx", "wy", "wz",
+    "fx", "fy", "fz", "tx", "ty", "tz", "invMass", "iix", "iiy", "iiz",
+};
+
+static void randomBodies(TestBodies& bodies, std::mt19937& rng) {
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    BodyArrays& b = bodies.arrays;
+    for (size_t i = 0; i < b.count; ++i) {
+        b.px[i] = 10.0f * unit(rng); b.py[i] = 10.0f * unit(rng); b.pz[i] = 10.0f * unit(rng);
+        float qx = unit(rng), qy = unit(rng), qz = unit(rng), qw = unit(rng);
+        float len = std::sqrt(qx * qx + qy * qy + qz * qz + qw * qw) + 1e-6f;
+        b.qx[i] = qx / len; b.qy[i] = qy / len; b.qz[i] = qz / len; b.qw[i] = qw / len;
+        b.vx[i] = 5.0f * unit(rng); b.vy[i] = 5.0f * unit(rng); b.vz[i] = 5.0f * unit(rng);
+        b.wx[i] = 3.0f * unit(rng); b.wy[i] = 3.0f * unit(rng); b.wz[i] = 3.0f * unit(rng);
+        b.fx[i] = 20.0f * unit(rng); b.fy[i] = 20.0f * unit(rng); b.fz[i] = 20.0f * unit(rng);
+        b.tx[i] = 2.0f * unit(rng); b.ty[i] = 2.0f * unit(rng); b.tz[i] = 2.0f * unit(rng);
+        bool kinematic = rng() % 4 == 0; // zero inverse mass and inertia, as createBody sets them
+        float mass = 0.5f + 2.5f * (unit(rng) + 1.0f);
+        glm::vec3 inertia = boxInertia(mass, glm::vec3(0.25f) + 0.5f * (unit(rng) + 1.0f));
+        b.invMass[i] = kinematic ? 0.0f : 1.0f / mass;
+        b.iix[i] = kinematic ? 0.0f : 1.0f / inertia.x;
+        b.iiy[i] = kinematic ? 0.0f : 1.0f / inertia.y;
+        b.iiz[i] = kinematic ? 0.0f : 1.0f / inertia.z;
+    }
+}
+
+// Largest difference over live bodies, relative to max(1, |reference|).
+static bool compare(const char* kernel, const TestBodies& reference, const TestBodies& wide, float tolerance) {
+    float worst = 0.0f;
+    int worstStream = 0;
+    size_t worstBody = 0;
+    for (int k = 0; k < STREAMS; ++k) {
+        for (size_t i = 0; i < reference.arrays.count; ++i) {
+            float r = reference.streams[k][i], w = wide.streams[k][i];
+            float error = std::fabs(r - w) / std::max(1.0f, std::fabs(r));
+            if (!(error <= worst)) { worst = error; worstStream = k; worstBody = i; }
+        }
+    }
+    bool inert = true;
+    const BodyArrays& b = wide.arrays;
+    for (size_t i = b.count; i < b.padded; ++i) {
+        inert = inert && b.px[i] == 0.0f && b.py[i] == 0.0f && b.pz[i] == 0.0f && b.qw[i] == 1.0f &&
+                b.qx[i] == 0.0f && b.qy[i] == 0.0f && b.qz[i] == 0.0f && b.vx[i] == 0.0f && b.vy[i] == 0.0f &&
+                b.vz[i] == 0.0f && b.wx[i] == 0.0f && b.wy[i] == 0.0f && b.wz[i] == 0.0f;
+    }
+    bool ok = worst <= tolerance && inert;
+    std::cout << (ok ? "ok   " : "FAIL ") << kernel << ": max relative error " << worst << " (" << streamNames[worstStream]
+              << " of body " << worstBody << ")" << (inert ? "" : ", padding lanes moved") << std::endl;
+    return ok;
+}
+
+static void applyForces(TestBodies& bodies, std::mt19937& rng) {
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    BodyArrays& b = bodies.arrays;
+    for (size_t i = 0; i < b.count; ++i) {
+        b.fx[i] = 20.0f * unit(rng); b.fy[i] = 20.0f * unit(rng); b.fz[i] = 20.0f * unit(rng);
+        b.tx[i] = 2.0f * unit(rng); b.ty[i] = 2.0f * unit(rng); b.tz[i] = 2.0f * unit(rng);
+    }
+}
+
+static bool testKernel(const char* name, void (*kernel)(const BodyArrays&, const IntegrationParams&), size_t count,
+                       unsigned int seed) {
+    size_t padded = (count + PHYSICS_LANES - 1) / PHYSICS_LANES * PHYSICS_LANES;
+    TestBodies reference(count, padded), wide(count, padded);
+    std::mt19937 rng(seed);
+    randomBodies(reference, rng);
+    wide.copyFrom(reference);
+
+    IntegrationParams params;
+    params.dt = 1.0f / 60.0f;
+    params.gravityY = -9.81f;
+    params.linearScale = 1.0f / (1.0f + params.dt * 0.1f);
+    params.angularScale = 1.0f / (1.0f + params.dt * 0.05f);
+
+    // new forces between steps keep the accumulators exercised; the same
+    // seed per step gives both copies identical ones
+    for (int step = 0; step < STEPS; ++step) {
+        integrateBodiesScalar(reference.arrays, params);
+        kernel(wide.arrays, params);
+        std::mt19937 forces(seed + 1 + step), forcesCopy(seed + 1 + step);
+        applyForces(reference, forces);
+        applyForces(wide, forcesCopy);
+    }
+
+    std::string label = std::string(name) + " x" + std::to_string(count);
+    // FMA contraction and a different summation order; errors stay around 1e-6
+    return compare(label.c_str(), reference, wide, 1e-4f);
+}
+
+int main(int argc, char** argv) {
+    unsigned int seed = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 12345u;
+
+    struct Kernel {
+        const char* name;
+        SimdLevel level;
+        void (*integrate)(const BodyArrays&, const IntegrationParams&);
+    };
+    std::vector<Kernel> kernels = { { "scalar", SIMD_SCALAR, simd_scalar::integrateBodies } };
+#ifdef SIMD_X86
+    kernels.push_back({ "sse2", SIMD_SSE2, simd_sse2::integrateBodies });
+    kernels.push_back({ "avx2", SIMD_AVX2, simd_avx2::integrateBodies });
+    kernels.push_back({ "avx512", SIMD_AVX512, simd_avx512::integrateBodies });
+#endif
+
+    SimdLevel detected = detectSimdLevel();
+    bool ok = true;
+    for (const Kernel& k : kernels) {
+        if (k.level > detected) {
+            std::cout << "skip " << k.name << ": not supported by this CPU" << std::endl;
+            continue;
+        }
+        // counts that leave the last block partly padded, and a multiple of every width
+        for (size_t count : { size_t(1), size_t(13), size_t(1000), size_t(4096) })
+            ok = testKernel(k.name, k.integrate, count, seed) && ok;
+    }
+    std::cout << (ok ? "all kernels match the scalar reference" : "kernel mismatch") << std::endl;
+    return ok ? 0 : 1;
+}
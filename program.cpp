@@ -1,5 +1,6 @@
 #include"classes/Shader.h"
 #include"classes/Mesh.h"
+#include"classes/NormalMatrix.h"
 #include"classes/Camera.h"
 #include"classes/load_texture_image.h"
 #include <glad/glad.h>
@@ -136,12 +137,13 @@ int main() {
         out vec2 TexCoord;
 
         uniform mat4 model;
+        uniform mat3 normalMatrix; // inverse-transpose of model, from the CPU
         uniform mat4 view;
         uniform mat4 projection;
 
         void main(){
             FragPos = vec3(model*vec4(aPos,1.0));
-            Normal = mat3(transpose(inverse(model)))*aNormal;
+            Normal = normalMatrix*aNormal;
             gl_Position = projection*view*model*vec4(aPos,1.0);
             TexCoord = aTexCoord;
         }
@@ -260,6 +262,7 @@ int main() {
         glUniform1i(glGetUniformLocation(shader.programID,"ourTexture"),0);
 
         shader.setMat4("model",model);
+        shader.setMat3("normalMatrix", normalMatrix(model, TRANSFORM_RIGID)); // pure rotation
         shader.setMat4("view",view);
         shader.setMat4("projection",projection);
         shader.setVec3("lightColor",light.Color);
@@ -0,0 +1,45 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 TexCoord;
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gParams;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+uniform mat4 view;
+
+uniform vec3 lightColor;
+uniform vec3 lightPos;
+uniform vec3 viewPos;
+
+#include "lighting.glsl"
+
+void main(){
+    float depth = texture(gDepth, TexCoord).r;
+    if (depth >= 1.0) discard; // background keeps the clear colour
+
+    vec4 clip = vec4(TexCoord * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * clip;
+    vec3 fragPos = world.xyz / world.w;
+
+    vec4 albedoSpec = texture(gAlbedo, TexCoord);
+    vec3 norm = normalize(texture(gNormal, TexCoord).xyz);
+    float shininess = texture(gParams, TexCoord).x * 256.0;
+
+    vec3 ambient = 0.3 * lightColor;
+    vec3 lightDir = normalize(lightPos - fragPos);
+    vec3 diffuse = max(dot(norm, lightDir), 0.0) * lightColor;
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    vec3 specular = albedoSpec.a * pow(max(dot(viewDir, reflectDir), 0.0), shininess) * lightColor;
+    vec3 lighting = ambient + diffuse + specular;
+    float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+#ifdef CLUSTERED_LIGHTS
+    lighting += clusteredLights(fragPos, viewDepth, norm, viewDir, albedoSpec.a, shininess);
+#endif
+#ifdef SHADOWS
+    lighting += sunLight(fragPos, viewDepth, norm, viewDir, albedoSpec.a, shininess);
+#endif
+    FragColor = vec4(albedoSpec.rgb * lighting, 1.0);
+}
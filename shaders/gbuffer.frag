@@ -0,0 +1,26 @@
+#version 330 core
+layout (location=0) out vec4 gAlbedo; // rgb albedo, a specular strength
+layout (location=1) out vec4 gNormal; // xyz world normal
+layout (location=2) out vec4 gParams; // x shininess / 256
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+flat in int MaterialIndex;
+
+#define MAX_MATERIALS 256
+struct Material {
+    vec4 colorSpecular;
+    vec4 params;
+};
+layout(std140) uniform Materials {
+    Material materials[MAX_MATERIALS];
+};
+
+uniform sampler2D ourTexture;
+
+void main(){
+    Material material = materials[MaterialIndex];
+    gAlbedo = vec4(texture(ourTexture, TexCoord).rgb * material.colorSpecular.rgb, material.colorSpecular.a);
+    gNormal = vec4(normalize(Normal), 0.0);
+    gParams = vec4(material.params.x / 256.0, 0.0, 0.0, 0.0);
+}
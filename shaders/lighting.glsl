@@ -0,0 +1,77 @@
+// Light evaluation shared by phong.frag and deferred_light.frag, pulled in
+// with #include "lighting.glsl" by ShaderLibrary after the feature defines.
+
+#ifdef SHADOWS
+// Cascaded sun shadows from CascadedShadows; SHADOW_CASCADES must match.
+#define SHADOW_CASCADES 4
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 cascadeMatrices[SHADOW_CASCADES];
+uniform float cascadeSplits[SHADOW_CASCADES]; // far view depth of each cascade
+uniform vec3 sunDirection;                    // direction the light travels
+uniform vec3 sunColor;
+
+float shadowFactor(vec3 fragPos, float viewDepth, vec3 norm){
+    if (viewDepth > cascadeSplits[SHADOW_CASCADES - 1]) return 1.0;
+    int cascade = 0;
+    while (cascade < SHADOW_CASCADES - 1 && viewDepth > cascadeSplits[cascade]) ++cascade;
+    vec4 p = cascadeMatrices[cascade] * vec4(fragPos, 1.0);
+    vec3 proj = p.xyz / p.w * 0.5 + 0.5;
+    if (proj.z > 1.0) return 1.0;
+    float bias = max(0.002 * (1.0 - dot(norm, -sunDirection)), 0.0005);
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; ++x)
+        for (int y = -1; y <= 1; ++y)
+            lit += texture(shadowMap, vec4(proj.xy + vec2(x, y) * texel, float(cascade), proj.z - bias));
+    return lit / 9.0;
+}
+
+vec3 sunLight(vec3 fragPos, float viewDepth, vec3 norm, vec3 viewDir, float specularStrength, float shininess){
+    vec3 l = -normalize(sunDirection);
+    float diff = max(dot(norm, l), 0.0);
+    float spec = pow(max(dot(viewDir, reflect(-l, norm)), 0.0), shininess);
+    return (diff + specularStrength * spec) * sunColor * shadowFactor(fragPos, viewDepth, norm);
+}
+#endif
+
+#ifdef CLUSTERED_LIGHTS
+// Filled each frame by ClusteredLighting; grid layout must match the C++
+// side. Each pixel only visits the lights whose volume overlaps its cluster.
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 24
+uniform samplerBuffer lightData;     // 3 texels per light
+uniform usamplerBuffer clusterGrid;  // (offset, count) per cluster
+uniform usamplerBuffer lightIndices;
+uniform vec2 clusterTileSize;        // pixels per tile
+uniform vec2 clusterSliceParams;     // slice = log(depth) * x - y
+
+vec3 clusteredLights(vec3 fragPos, float viewDepth, vec3 norm, vec3 viewDir, float specularStrength, float shininess){
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterTileSize), ivec2(0), ivec2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+    int slice = clamp(int(log(viewDepth) * clusterSliceParams.x - clusterSliceParams.y), 0, CLUSTER_SLICES - 1);
+    uvec2 cell = texelFetch(clusterGrid, (slice * CLUSTER_TILES_Y + tile.y) * CLUSTER_TILES_X + tile.x).rg;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < cell.y; ++i) {
+        int light = int(texelFetch(lightIndices, int(cell.x + i)).r) * 3;
+        vec4 posRadius = texelFetch(lightData, light);
+        vec4 colorOuter = texelFetch(lightData, light + 1);
+        vec4 dirInner = texelFetch(lightData, light + 2);
+
+        vec3 toLight = posRadius.xyz - fragPos;
+        float dist = length(toLight);
+        vec3 l = toLight / max(dist, 1e-4);
+        // windowed inverse square, reaches zero at the light radius
+        float ratio = dist / posRadius.w;
+        float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (dist * dist + 1.0);
+        if (colorOuter.w > -1.0)
+            attenuation *= smoothstep(colorOuter.w, dirInner.w, dot(-l, dirInner.xyz));
+
+        float diff = max(dot(norm, l), 0.0);
+        float spec = pow(max(dot(viewDir, reflect(-l, norm)), 0.0), shininess);
+        result += (diff + specularStrength * spec) * colorOuter.rgb * attenuation;
+    }
+    return result;
+}
+#endif
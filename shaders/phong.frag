@@ -0,0 +1,85 @@
+#version 330 core
+out vec4 FragColor;
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+flat in int MaterialIndex;
+
+// Written once by MaterialLibrary; MAX_MATERIALS must match the C++ side.
+#define MAX_MATERIALS 256
+struct Material {
+    vec4 colorSpecular; // rgb colour, specular strength
+    vec4 params;        // x = shininess
+};
+layout(std140) uniform Materials {
+    Material materials[MAX_MATERIALS];
+};
+
+uniform vec3 lightColor;
+uniform vec3 lightPos;
+uniform vec3 viewPos;
+
+#ifdef TEXTURE_ARRAY
+uniform sampler2DArray ourTextureArray;
+uniform float textureLayer;
+#else
+uniform sampler2D ourTexture;
+#endif
+
+#ifdef NORMAL_MAP
+uniform sampler2D normalMap;
+
+// Mesh has no tangent stream, so build the tangent frame from screen-space
+// derivatives of position and uv.
+vec3 perturbNormal(vec3 n, vec3 p, vec2 uv){
+    vec3 dp1 = dFdx(p);
+    vec3 dp2 = dFdy(p);
+    vec2 duv1 = dFdx(uv);
+    vec2 duv2 = dFdy(uv);
+    vec3 dp2perp = cross(dp2, n);
+    vec3 dp1perp = cross(n, dp1);
+    vec3 t = dp2perp * duv1.x + dp1perp * duv2.x;
+    vec3 b = dp2perp * duv1.y + dp1perp * duv2.y;
+    float invmax = inversesqrt(max(dot(t,t), dot(b,b)));
+    mat3 tbn = mat3(t * invmax, b * invmax, n);
+    vec3 mapped = texture(normalMap, uv).xyz * 2.0 - 1.0;
+    return normalize(tbn * mapped);
+}
+#endif
+
+#if defined(CLUSTERED_LIGHTS) || defined(SHADOWS)
+in float ViewDepth;
+#endif
+
+#include "lighting.glsl"
+
+void main(){
+    Material material = materials[MaterialIndex];
+    float ambientStrength = 0.3;
+    vec3 ambient = ambientStrength * lightColor;
+    vec3 norm = normalize(Normal);
+#ifdef NORMAL_MAP
+    norm = perturbNormal(norm, FragPos, TexCoord);
+#endif
+    vec3 lightDir = normalize(lightPos - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * lightColor;
+    float specularStrength = material.colorSpecular.a;
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.params.x);
+    vec3 specular = specularStrength * spec * lightColor;
+    vec3 phong = ambient + diffuse + specular;
+#ifdef CLUSTERED_LIGHTS
+    phong += clusteredLights(FragPos, ViewDepth, norm, viewDir, specularStrength, material.params.x);
+#endif
+#ifdef SHADOWS
+    phong += sunLight(FragPos, ViewDepth, norm, viewDir, specularStrength, material.params.x);
+#endif
+#ifdef TEXTURE_ARRAY
+    vec3 texColor = texture(ourTextureArray, vec3(TexCoord, textureLayer)).rgb;
+#else
+    vec3 texColor = texture(ourTexture, TexCoord).rgb;
+#endif
+    FragColor = vec4(texColor * material.colorSpecular.rgb * phong, 1.0);
+}
@@ -0,0 +1,47 @@
+#version 330 core
+layout (location=0) in vec3 aPos;
+layout (location=1) in vec3 aNormal;
+layout (location=2) in vec2 aTexCoord;
+#ifdef INSTANCING
+layout (location=3) in mat4 aModel; // occupies locations 3-6
+layout (location=7) in int aMaterialIndex;
+layout (location=8) in mat3 aNormalMatrix; // occupies locations 8-10
+#else
+uniform int materialIndex;
+uniform mat3 normalMatrix; // inverse-transpose of model, computed on the CPU
+#endif
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+flat out int MaterialIndex;
+#if defined(CLUSTERED_LIGHTS) || defined(SHADOWS)
+out float ViewDepth;
+#endif
+
+// the depth prepass runs this same shader, so positions must match bit for bit
+invariant gl_Position;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main(){
+#ifdef INSTANCING
+    mat4 world = aModel;
+    mat3 worldNormal = aNormalMatrix;
+    MaterialIndex = aMaterialIndex;
+#else
+    mat4 world = model;
+    mat3 worldNormal = normalMatrix;
+    MaterialIndex = materialIndex;
+#endif
+    FragPos = vec3(world * vec4(aPos,1.0));
+    Normal = worldNormal * aNormal;
+    TexCoord = aTexCoord;
+    vec4 viewPos = view * vec4(FragPos,1.0);
+#if defined(CLUSTERED_LIGHTS) || defined(SHADOWS)
+    ViewDepth = -viewPos.z;
+#endif
+    gl_Position = projection * viewPos;
+}
@@ -1,21 +1,52 @@
 #include "classes/Shader.h"
+#include "classes/ShaderLibrary.h"
 #include "classes/Mesh.h"
+#include "classes/Material.h"
 #include "classes/Camera.h"
 #include "classes/stb_image.h"
+#include "classes/PakArchive.h"
+#include "classes/AsyncAssetLoader.h"
+#include "classes/StreamingManager.h"
+#include "classes/ClusteredLighting.h"
+#include "classes/CascadedShadows.h"
+#include "classes/ForwardRenderer.h"
+#include "classes/DeferredRenderer.h"
+#include "classes/DynamicResolution.h"
+#include "classes/FixedTimestep.h"
+#include "classes/PhysicsWorld.h"
+#include "classes/SweepAndPrune.h"
+#include "classes/DynamicAabbTree.h"
+#include "classes/UniformGridBroadphase.h"
+#include "classes/ConvexHull.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <vector>
 
 // Orbit Camera
 OrbitCamera camera(glm::vec3(0.0f), 5.0f);
 
+// Packed assets (build with pak_builder); loose files are used when absent
+PakArchive assets;
+
+int screenWidth = 800, screenHeight = 600;
+
+// Scene resolution follows GPU frame time; the result is upscaled to the window
+DynamicResolution resolution;
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    screenWidth = width;
+    screenHeight = height;
+    resolution.resize(width, height);
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
@@ -26,41 +57,6 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     camera.processMouseScroll(yoffset);
 }
 
-// Simple texture loader
-unsigned int loadTexture(const char* path)
-{
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        GLenum format = GL_RGB;
-        if (nrChannels == 1) format = GL_RED;
-        else if (nrChannels == 4) format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Failed to load texture at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
-}
-
 // Cube vertices: positions, normals, texcoords
 std::vector<float> cubeVertices = {
     // positions          // normals       // texcoords
@@ -107,75 +103,88 @@ std::vector<float> cubeVertices = {
    -0.5f, 0.5f,-0.5f,    0.0f,1.0f,0.0f,  0.0f,1.0f
 };
 
-// Vertex and fragment shader sources
-const char* vertexShaderSource = R"GLSL(
-    #version 330 core
-    layout (location=0) in vec3 aPos;
-    layout (location=1) in vec3 aNormal;
-    layout (location=2) in vec2 aTexCoord;
-    out vec3 FragPos;
-    out vec3 Normal;
-    out vec2 TexCoord;
-    uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
-    void main(){
-        FragPos = vec3(model * vec4(aPos,1.0));
-        Normal = mat3(transpose(inverse(model))) * aNormal;
-        TexCoord = aTexCoord;
-        gl_Position = projection * view * vec4(FragPos,1.0);
-    }
-)GLSL";
-
-const char* fragmentShaderSource = R"GLSL(
-    #version 330 core
-    out vec4 FragColor;
-    in vec3 FragPos;
-    in vec3 Normal;
-    in vec2 TexCoord;
-    uniform vec3 lightColor;
-    uniform vec3 lightPos;
-    uniform vec3 viewPos;
-    uniform sampler2D ourTexture;
-    void main(){
-        float ambientStrength = 0.3;
-        vec3 ambient = ambientStrength * lightColor;
-        vec3 norm = normalize(Normal);
-        vec3 lightDir = normalize(lightPos - FragPos);
-        float diff = max(dot(norm, lightDir), 0.0);
-        vec3 diffuse = diff * lightColor;
-        float specularStrength = 0.5;
-        vec3 viewDir = normalize(viewPos - FragPos);
-        vec3 reflectDir = reflect(-lightDir, norm);
-        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-        vec3 specular = specularStrength * spec * lightColor;
-        vec3 phong = ambient + diffuse + specular;
-        vec3 texColor = texture(ourTexture, TexCoord).rgb;
-        FragColor = vec4(texColor * phong, 1.0);
-    }
-)GLSL";
-
-const char* lightVertexShaderSource = R"GLSL(
-    #version 330 core
-    layout (location=0) in vec3 aPos;
-    uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
-    void main(){
-        gl_Position = projection * view * model * vec4(aPos, 1.0);
+// Ground quad under the cube, static so it lands in the cached cascades
+std::vector<float> floorVertices = {
+   -10.0f,-1.5f,-10.0f,   0.0f,1.0f,0.0f,  0.0f,10.0f,
+    10.0f,-1.5f, 10.0f,   0.0f,1.0f,0.0f, 10.0f, 0.0f,
+    10.0f,-1.5f,-10.0f,   0.0f,1.0f,0.0f, 10.0f,10.0f,
+    10.0f,-1.5f, 10.0f,   0.0f,1.0f,0.0f, 10.0f, 0.0f,
+   -10.0f,-1.5f,-10.0f,   0.0f,1.0f,0.0f,  0.0f,10.0f,
+   -10.0f,-1.5f, 10.0f,   0.0f,1.0f,0.0f,  0.0f, 0.0f
+};
+
+// Registers a texture with the streaming manager so its mip level follows
+// the camera distance. Loads that complete after a newer request or release
+// are dropped, so an old level never replaces a newer one.
+StreamingManager::Handle streamTexture(StreamingManager& streaming, AsyncAssetLoader& loader, const std::string& path,
+                                       unsigned int* texture, const glm::vec3& position, float radius) {
+    int width, height, channels;
+    if (!loader.textureInfo(path, width, height, channels)) {
+        std::cout << "ERROR::STREAMING::NO_TEXTURE_INFO " << path << std::endl;
+        loader.requestTexture(path, texture);
+        return static_cast<StreamingManager::Handle>(-1);
     }
-)GLSL";
-
-const char* lightFragmentShaderSource = R"GLSL(
-    #version 330 core
-    out vec4 FragColor;
-    uniform vec3 lightColor;
-    void main(){
-        FragColor = vec4(lightColor, 1.0);
+
+    StreamingManager::Handle h = streaming.add(position, radius, textureStreamLevels(width, height, channels, 6));
+    auto generation = std::make_shared<unsigned int>(0);
+    // swaps t in if it is still the latest load, else deletes it
+    auto swapIn = [texture, generation](unsigned int t, unsigned int gen) {
+        if (gen != *generation) {
+            glDeleteTextures(1, &t);
+            return false;
+        }
+        if (*texture) glDeleteTextures(1, texture);
+        *texture = t;
+        return true;
+    };
+
+    StreamCallbacks callbacks;
+    callbacks.request = [&streaming, &loader, path, generation, swapIn, h](int level, uint32_t ticket) {
+        unsigned int gen = ++*generation;
+        loader.requestTexture(path, nullptr, [&streaming, swapIn, gen, h, level, ticket](unsigned int t) {
+            // a cancelled request's texture is dropped without touching the drawn one
+            if (!streaming.onLoaded(h, ticket, level)) glDeleteTextures(1, &t);
+            else swapIn(t, gen);
+        }, level);
+    };
+    callbacks.release = [&loader, path, texture, generation, swapIn](int level) {
+        unsigned int gen = ++*generation;
+        if (level == StreamingManager::NOT_RESIDENT) {
+            if (*texture) glDeleteTextures(1, texture);
+            *texture = 0;
+            return;
+        }
+        // keep drawing the finer level until the coarser one is uploaded
+        loader.requestTexture(path, nullptr, [swapIn, gen](unsigned int t) { swapIn(t, gen); }, level);
+    };
+    streaming.setCallbacks(h, callbacks);
+    return h;
+}
+
+int main(int argc, char** argv) {
+    // --renderer=forward (default) or --renderer=deferred
+    // --prepass starts the forward renderer with a depth prepass (toggle with P)
+    // --stats prints per-second frame counters
+    // --target-ms=N sets the dynamic resolution budget, --no-dynres pins it to native
+    // --physics-hz=N sets the simulation rate, --extrapolate renders ahead of it instead of behind
+    // --broadphase=sap (default), --broadphase=tree or --broadphase=grid
+    std::string rendererName = "forward";
+    std::string broadphaseName = "sap";
+    bool prepass = false, printStats = false;
+    FixedTimestep simClock;
+    RenderTransformMode bodyTransforms = RENDER_INTERPOLATE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--renderer=", 0) == 0) rendererName = arg.substr(11);
+        else if (arg == "--prepass") prepass = true;
+        else if (arg == "--stats") printStats = true;
+        else if (arg == "--no-dynres") resolution.enabled = false;
+        else if (arg.rfind("--target-ms=", 0) == 0) resolution.targetFrameMs = std::stof(arg.substr(12));
+        else if (arg.rfind("--physics-hz=", 0) == 0) simClock.hz = std::stof(arg.substr(13));
+        else if (arg == "--extrapolate") bodyTransforms = RENDER_EXTRAPOLATE;
+        else if (arg.rfind("--broadphase=", 0) == 0) broadphaseName = arg.substr(13);
     }
-)GLSL";
 
-int main() {
     // GLFW init
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
@@ -192,19 +201,112 @@ int main() {
 
     glEnable(GL_DEPTH_TEST);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwGetFramebufferSize(window, &screenWidth, &screenHeight);
+    resolution.init();
+    resolution.resize(screenWidth, screenHeight);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
 
-    Shader shader(vertexShaderSource, fragmentShaderSource);
-    Shader lightShader(lightVertexShaderSource, lightFragmentShaderSource);
+    if (std::ifstream("assets.pak")) assets.open("assets.pak");
+
+    // linked programs are reused across launches when the driver allows it
+    ShaderCache shaderCache;
+    shaderCache.init();
+
+    ShaderLibrary shaders("shaders", &shaderCache);
+    shaders.init();
+    ShaderLibrary::ProgramId lightProgram = shaders.add("light", "light.vert", "light.frag");
+
+    // textures stream in while the first frames render
+    AsyncAssetLoader loader;
+    loader.setArchive(&assets);
 
+    // mip levels follow the camera distance; the first update() requests them
+    StreamingManager streaming(64u << 20, 64u << 20);
     Mesh cube(cubeVertices);
-    cube.texture = loadTexture("container2.png");
+    StreamingManager::Handle cubeStream = streamTexture(streaming, loader, "container2.png", &cube.texture,
+                                                        glm::vec3(0.0f), 0.87f);
+    Mesh ground(floorVertices);
+    StreamingManager::Handle groundStream = streamTexture(streaming, loader, "wood.png", &ground.texture,
+                                                          glm::vec3(0.0f, -1.5f, 0.0f), 14.3f);
+
+    MaterialLibrary materials;
+    Material container;
+    container.Color = glm::vec3(1.0f);
+    container.SpecularStrength = 0.5f;
+    container.Shininess = 32.0f;
+    int containerMaterial = materials.add(container);
+    materials.upload();
+
+    std::unique_ptr<Renderer> renderer;
+    ForwardRenderer* forward = nullptr;
+    if (rendererName == "deferred") {
+        renderer.reset(new DeferredRenderer());
+    } else {
+        forward = new ForwardRenderer();
+        forward->depthPrepass = prepass;
+        renderer.reset(forward);
+    }
+    renderer->init(shaders, materials);
+    std::cout << "Renderer: " << renderer->name() << std::endl;
+
+    CascadedShadows shadows;
+    shadows.init(shaders);
+
+    RenderGraph frameGraph;
 
     glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 
-    float lastFrame = 0.0f;
+    // ring of coloured point lights plus one spot, shaded per cluster
+    ClusteredLighting clustered;
+    clustered.init();
+    const int ringLights = 64;
+    for (int i = 0; i < ringLights; ++i) {
+        ClusterLight light;
+        float hue = float(i) / ringLights * 6.2831853f;
+        light.color = glm::vec3(0.5f + 0.5f * cos(hue), 0.5f + 0.5f * cos(hue + 2.094f), 0.5f + 0.5f * cos(hue + 4.189f));
+        light.radius = 1.5f;
+        light.intensity = 2.0f;
+        clustered.lights.push_back(light);
+    }
+    ClusterLight spot;
+    spot.position = glm::vec3(0.0f, 3.0f, 0.0f);
+    spot.radius = 6.0f;
+    spot.intensity = 4.0f;
+    spot.spotCosInner = cos(glm::radians(15.0f));
+    spot.spotCosOuter = cos(glm::radians(25.0f));
+    clustered.lights.push_back(spot);
+
+    // the cube spins as a kinematic body: no gravity, constant angular velocity
+    PhysicsWorld physics;
+    BodyDesc cubeDesc;
+    cubeDesc.mass = 0.0f;
+    cubeDesc.angularVelocity = glm::normalize(glm::vec3(0.5f, 1.0f, 0.0f)) * glm::radians(50.0f);
+    BodyHandle cubeBody = physics.createBody(cubeDesc);
+    BodyDesc groundDesc;
+    groundDesc.mass = 0.0f;
+    groundDesc.position = glm::vec3(0.0f, -1.5f, 0.0f);
+    groundDesc.halfExtents = glm::vec3(10.0f, 0.01f, 10.0f);
+    physics.createBody(groundDesc);
+
+    std::unique_ptr<Broadphase> broadphase;
+    if (broadphaseName == "tree") broadphase.reset(new DynamicAabbTree());
+    else if (broadphaseName == "grid") broadphase.reset(new UniformGridBroadphase());
+    else broadphase.reset(new SweepAndPrune());
+    physics.setBroadphase(broadphase.get());
+    std::cout << "Broadphase: " << broadphase->name() << std::endl;
+    ConvexHullCache hulls;
+    if (const ConvexHull* cubeHull = hulls.hullFor(cube))
+        std::cout << "Cube collision hull: " << cubeHull->vertices.size() << " vertices, " << cubeHull->faces.size() << " faces" << std::endl;
+    std::vector<glm::mat4> bodyMatrices;
+    std::vector<ContactManifold> contacts;
+    std::cout << "SIMD kernels: " << simdLevelName(simdKernels().level) << std::endl;
+
+    float lastFrame = glfwGetTime();
+    float lastStatsTime = 0.0f;
+    int framesSinceStats = 0;
+    bool prepassKeyDown = false;
 
     while(!glfwWindowShouldClose(window)) {
         float currentFrame = glfwGetTime();
@@ -214,44 +316,129 @@ int main() {
         if(glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
             glfwSetWindowShouldClose(window,true);
 
-        glClearColor(0.1f,0.1f,0.1f,1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        bool prepassKey = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+        if (forward && prepassKey && !prepassKeyDown) {
+            forward->depthPrepass = !forward->depthPrepass;
+            std::cout << "Depth prepass " << (forward->depthPrepass ? "on" : "off") << std::endl;
+        }
+        prepassKeyDown = prepassKey;
+
+        // both objects are always in view in this scene
+        if (cubeStream < streaming.resourceCount()) streaming.markVisible(cubeStream);
+        if (groundStream < streaming.resourceCount()) streaming.markVisible(groundStream);
+        streaming.update(camera);
+        loader.update();
+        shaders.update();
+        int substeps = simClock.advance(deltaTime);
+        for (int i = 0; i < substeps; ++i) physics.step(simClock.stepSeconds());
+        physics.collideBoxes(contacts);
+
+        resolution.beginFrame(0.1f, 0.1f, 0.1f);
 
         glm::mat4 view = camera.getViewMatrix();
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f/600.0f, 0.1f, 100.0f);
+        float aspect = screenHeight > 0 ? float(screenWidth) / screenHeight : 1.0f;
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+
+        for (int i = 0; i < ringLights; ++i) {
+            float a = currentFrame * 0.5f + float(i) / ringLights * 6.2831853f;
+            clustered.lights[i].position = glm::vec3(cos(a) * 1.5f, sin(a * 3.0f) * 0.8f, sin(a) * 1.5f);
+        }
+        clustered.setProjection(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        clustered.update(view);
 
         // Main cube
-        shader.use();
-        glm::mat4 model = glm::rotate(glm::mat4(1.0f), glm::radians(50.0f) * currentFrame,
-                                      glm::vec3(0.5f, 1.0f, 0.0f));
-        shader.setMat4("model", model);
-        shader.setMat4("view", view);
-        shader.setMat4("projection", projection);
-        shader.setVec3("lightColor", glm::vec3(1.0f));
-        shader.setVec3("lightPos", lightPos);
-        shader.setVec3("viewPos", camera.getPosition());
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, cube.texture);
-        shader.setInt("ourTexture", 0);
-        cube.Draw();
-
-        // Light cube orbiting
-        lightShader.use();
-        float radius = 2.0f;
-        float lightX = sin(currentFrame) * radius;
-        float lightZ = cos(currentFrame) * radius;
-        glm::mat4 lightModel = glm::translate(glm::mat4(1.0f), glm::vec3(lightX, 1.0f, lightZ));
-        lightModel = glm::scale(lightModel, glm::vec3(0.2f));
-        lightShader.setMat4("model", lightModel);
-        lightShader.setMat4("view", view);
-        lightShader.setMat4("projection", projection);
-        lightShader.setVec3("lightColor", glm::vec3(1.0f));
-        cube.Draw(); // light uses same mesh
+        RenderScene scene;
+        DrawItem item;
+        item.mesh = &cube;
+        physics.renderTransforms(simClock.alpha(), bodyTransforms, bodyMatrices);
+        item.model = bodyMatrices[physics.indexOf(cubeBody)];
+        item.boundingRadius = 0.87f; // half the unit cube's diagonal
+        item.transform = TRANSFORM_RIGID; // physics bodies only rotate and translate
+        item.material = containerMaterial;
+        scene.items.push_back(item);
+        DrawItem floorItem;
+        floorItem.mesh = &ground;
+        floorItem.material = containerMaterial;
+        floorItem.isStatic = true;
+        floorItem.transform = TRANSFORM_RIGID;
+        floorItem.boundingRadius = 14.3f;
+        scene.items.push_back(floorItem);
+        scene.lightPos = lightPos;
+        scene.lightColor = glm::vec3(1.0f);
+        scene.lights = &clustered;
+        scene.sunDirection = glm::vec3(-0.4f, -1.0f, -0.3f);
+        scene.sunColor = glm::vec3(0.6f);
+        scene.shadows = &shadows;
+
+        RenderView renderView;
+        renderView.view = view;
+        renderView.projection = projection;
+        renderView.position = camera.getPosition();
+        renderView.width = resolution.renderTargetWidth();
+        renderView.height = resolution.renderTargetHeight();
+        renderView.nearPlane = 0.1f;
+        renderView.farPlane = 100.0f;
+
+        // frame graph: shadows -> scene -> light gizmo overlay
+        frameGraph.reset(renderView.width, renderView.height, resolution.framebuffer());
+        shadows.addPass(frameGraph, scene, renderView);
+        renderer->addPasses(frameGraph, scene, renderView);
+
+        RenderPassBuilder overlay = frameGraph.addPass("light_gizmo");
+        overlay.writeBackbuffer();
+        overlay.execute([&](RenderGraph&) {
+            Shader* gizmoShader = shaders.get(lightProgram, 0);
+            if (!gizmoShader) return; // build failure already logged
+            Shader& lightShader = *gizmoShader;
+            lightShader.use();
+            float radius = 2.0f;
+            float lightX = sin(currentFrame) * radius;
+            float lightZ = cos(currentFrame) * radius;
+            glm::mat4 lightModel = glm::translate(glm::mat4(1.0f), glm::vec3(lightX, 1.0f, lightZ));
+            lightModel = glm::scale(lightModel, glm::vec3(0.2f));
+            lightShader.setMat4("model", lightModel);
+            lightShader.setMat4("view", view);
+            lightShader.setMat4("projection", projection);
+            lightShader.setVec3("lightColor", glm::vec3(1.0f));
+            cube.Draw(); // light uses same mesh
+        });
+
+        frameGraph.compile();
+        frameGraph.execute();
+        resolution.endFrame();
+        resolution.present();
+
+        ++framesSinceStats;
+        if (printStats && currentFrame - lastStatsTime >= 1.0f) {
+            const RenderStats& stats = renderer->stats();
+            std::cout << renderer->name() << (stats.depthPrepass ? "+prepass" : "")
+                      << " fps=" << framesSinceStats / (currentFrame - lastStatsTime)
+                      << " draws=" << stats.drawCalls << " depthDraws=" << stats.depthDrawCalls
+                      << " culled=" << stats.culledItems
+                      << " shadedSamples=" << stats.shadedSamples
+                      << " prepassMs=" << stats.prepassMs << " colourMs=" << stats.colourMs
+                      << " shadowCascades=" << shadows.cascadesRenderedLastFrame()
+                      << " passes=" << frameGraph.stats().declaredPasses - frameGraph.stats().culledPasses
+                      << " targets=" << frameGraph.stats().physicalTextures << "/" << frameGraph.stats().transientResources
+                      << " targetMB=" << frameGraph.stats().allocatedBytes / (1024.0 * 1024.0)
+                      << " scale=" << resolution.scale() << " gpuMs=" << resolution.lastGpuMs()
+                      << " physicsHz=" << simClock.hz << " pairs=" << broadphase->pairs().size()
+                      << " contacts=" << contacts.size() << " droppedSimS=" << simClock.dropped() << std::endl;
+            lastStatsTime = currentFrame;
+            framesSinceStats = 0;
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    frameGraph.cleanUp();
+    resolution.cleanUp();
+    renderer->cleanUp();
+    shadows.cleanUp();
+    clustered.cleanUp();
+    materials.cleanUp();
+    shaders.cleanUp();
     glfwTerminate();
     return 0;
 }